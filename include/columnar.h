@@ -0,0 +1,132 @@
+/**
+ * @file columnar.h
+ * @author Mao Zhang (mao.zhang233@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef JSON_PARSER_INCLUDE_COLUMNAR_H_
+#define JSON_PARSER_INCLUDE_COLUMNAR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jpp {
+
+enum class ColumnType { Double, Int64, String, Boolean };
+
+/**
+ * @brief Field to extract, path is a dot separated list of object keys
+ * (e.g. "user.id"), keys are compared with their raw bytes
+ *
+ */
+struct ColumnSpec {
+  std::string path;
+  ColumnType type;
+};
+
+/**
+ * @brief Contiguous values of one field, one row per record. Only the
+ * vector matching type is filled, a missing or mistyped field becomes a
+ * null row holding 0, false or an empty string. Of duplicate keys only the
+ * first occurrence is looked at, as with JSON::FindObjectValue, so a
+ * mistyped first value gives null even if a later one would fit.
+ *
+ */
+struct Column {
+  explicit Column(ColumnType type = ColumnType::Double);
+
+  /**
+   * @brief Check whether row holds a value
+   *
+   * @param row
+   * @return true
+   * @return false null
+   */
+  bool IsValid(std::size_t row) const noexcept {
+    return (validity[row / 64] >> (row % 64)) & 1;
+  }
+
+  /**
+   * @brief Get string of row, column type must be String
+   *
+   * @param row
+   * @return std::string_view
+   */
+  std::string_view GetString(std::size_t row) const noexcept {
+    return std::string_view(bytes.data() + offsets[row],
+                            offsets[row + 1] - offsets[row]);
+  }
+
+  /**
+   * @brief Append rows of other, a column of the same type
+   *
+   * @param other
+   */
+  void Append(const Column& other);
+
+  ColumnType type;
+  std::size_t size;
+  std::size_t null_count;
+  // bit per row, set when row holds a value
+  std::vector<std::uint64_t> validity;
+  std::vector<double> doubles;
+  std::vector<std::int64_t> int64s;
+  std::vector<std::uint8_t> booleans;
+  // string of row i is bytes[offsets[i], offsets[i + 1])
+  std::vector<std::uint64_t> offsets;
+  std::vector<char> bytes;
+};
+
+/**
+ * @brief Pulls a few fields out of NDJSON records straight into columns.
+ * Records are only scanned, values of fields not asked for are skipped
+ * without being converted or stored, and nothing is allocated per record.
+ *
+ */
+class ColumnExtractor {
+ public:
+  /**
+   * @brief Construct with the fields to extract
+   *
+   * @param specs
+   * @param threads number of threads a batch is split over
+   */
+  explicit ColumnExtractor(std::vector<ColumnSpec> specs,
+                           unsigned threads = 1);
+
+  /**
+   * @brief Append a row per record of ndjson to columns, one column per
+   * spec. Blank lines are skipped, a record that cannot be scanned becomes
+   * a row of nulls.
+   *
+   * @param ndjson null terminated
+   * @param columns created on first use, appended to afterwards
+   * @return std::size_t number of records that could not be scanned
+   */
+  std::size_t Extract(const char* ndjson, std::vector<Column>* columns) const;
+
+ private:
+  class Scanner;
+
+  // paths form a tree of keys, the root stands for the record itself
+  struct PathNode {
+    std::string key;
+    std::vector<std::size_t> children;
+    std::vector<std::size_t> columns;
+  };
+
+  std::vector<ColumnSpec> specs_;
+  std::vector<PathNode> nodes_;
+  unsigned threads_;
+};
+
+}  // namespace jpp
+
+#endif  // JSON_PARSER_INCLUDE_COLUMNAR_H_
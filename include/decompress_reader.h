@@ -0,0 +1,164 @@
+/**
+ * @file decompress_reader.h
+ * @author Mao Zhang (mao.zhang233@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef JSON_PARSER_INCLUDE_DECOMPRESS_READER_H_
+#define JSON_PARSER_INCLUDE_DECOMPRESS_READER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifndef JPP_DECOMPRESS_BUFFER_SIZE
+#define JPP_DECOMPRESS_BUFFER_SIZE (4 << 20)
+#endif
+
+#ifndef JPP_DECOMPRESS_BUFFER_COUNT
+#define JPP_DECOMPRESS_BUFFER_COUNT 4
+#endif
+
+namespace jpp {
+
+enum class Compression { None, Gzip, Zstd };
+
+class DecompressSource;
+
+/**
+ * @brief Reads a file, gzip or zstd compressed or plain, in chunks. A
+ * producer thread decompresses ahead into a ring of reusable buffers while
+ * the caller parses the chunks it already got.
+ *
+ */
+class DecompressReader {
+ public:
+  /**
+   * @brief Buffer of decompressed bytes. Unlike a resized std::string it is
+   * filled without zeroing the bytes first.
+   *
+   */
+  class Chunk {
+   public:
+    const char* Data() const noexcept { return data_.get(); }
+    std::size_t Length() const noexcept { return length_; }
+    std::string_view View() const noexcept {
+      return std::string_view(data_.get(), length_);
+    }
+
+   private:
+    friend class DecompressReader;
+
+    // make room for length bytes and the '\0' behind them, keeping the
+    // bytes already held
+    void Reserve(std::size_t length);
+
+    std::unique_ptr<char[]> data_;
+    std::size_t capacity_ = 0;
+    std::size_t length_ = 0;
+  };
+
+  /**
+   * @brief Construct reader
+   *
+   * @param whole_lines cut chunks right after a '\n' (or at end of input),
+   * so no NDJSON record is split between chunks
+   * @param buffer_size size a chunk is filled up to
+   * @param buffer_count number of chunks decompressed ahead
+   */
+  explicit DecompressReader(
+      bool whole_lines, std::size_t buffer_size = JPP_DECOMPRESS_BUFFER_SIZE,
+      std::size_t buffer_count = JPP_DECOMPRESS_BUFFER_COUNT);
+  ~DecompressReader();
+
+  DecompressReader(const DecompressReader&) = delete;
+  DecompressReader& operator=(const DecompressReader&) = delete;
+
+  /**
+   * @brief Detect compression of file from its leading magic bytes. Only
+   * regular files are looked at, reading a pipe here would consume the
+   * bytes, so anything else is reported as Compression::None.
+   *
+   * @param path
+   * @return Compression
+   */
+  static Compression Detect(const char* path);
+
+  /**
+   * @brief Check whether this build can decompress compression
+   *
+   * @param compression
+   * @return true
+   * @return false library was not found at build time
+   */
+  static bool Supported(Compression compression);
+
+  /**
+   * @brief Open file and start decompressing in the background
+   *
+   * @param path
+   * @return false if the file cannot be opened or its compression is not
+   * supported, see Error
+   */
+  bool Open(const char* path);
+
+  /**
+   * @brief Get the next chunk, waiting for the producer if needed. The
+   * chunk is swapped into chunk, whatever chunk held before goes back to
+   * the ring, so no buffer is allocated once the ring is warm. A chunk is
+   * always followed by '\0'.
+   *
+   * @param chunk
+   * @return false at end of input or on error, see Error
+   */
+  bool Next(Chunk* chunk);
+
+  /**
+   * @brief Get error message, empty unless Open or Next failed
+   *
+   * @return const std::string&
+   */
+  const std::string& Error() const noexcept { return error_; }
+
+  /**
+   * @brief Get the number of decompressed bytes handed out so far
+   *
+   * @return std::size_t
+   */
+  std::size_t BytesRead() const noexcept { return bytes_read_; }
+
+ private:
+  void Produce();
+
+  bool whole_lines_;
+  std::size_t buffer_size_;
+  std::unique_ptr<DecompressSource> source_;
+  std::thread producer_;
+
+  // ring of buffers, [head_, tail_) are filled and wait for the consumer
+  std::mutex mutex_;
+  std::condition_variable filled_;
+  std::condition_variable emptied_;
+  std::vector<Chunk> ring_;
+  std::size_t head_;
+  std::size_t tail_;
+  bool done_;
+  bool stop_;
+  std::string producer_error_;
+
+  std::string error_;
+  std::size_t bytes_read_;
+};
+
+}  // namespace jpp
+
+#endif  // JSON_PARSER_INCLUDE_DECOMPRESS_READER_H_
@@ -0,0 +1,65 @@
+/**
+ * @file formatter.h
+ * @author Mao Zhang (mao.zhang233@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef JSON_PARSER_INCLUDE_FORMATTER_H_
+#define JSON_PARSER_INCLUDE_FORMATTER_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace jpp {
+
+/**
+ * @brief Streaming minifier / pretty printer working on raw bytes, no
+ * document is built. Input may be fed in arbitrary pieces. Input is not
+ * validated, invalid JSON comes out reformatted but still invalid.
+ *
+ */
+class Formatter {
+ public:
+  /**
+   * @brief Construct formatter
+   *
+   * @param pretty indent by two spaces instead of minifying
+   * @param out formatted text is appended here
+   */
+  Formatter(bool pretty, std::string* out) : pretty_(pretty), out_(out) {}
+
+  /**
+   * @brief Format the next piece of input, it may end anywhere, even inside
+   * a string or an escape
+   *
+   * @param data
+   */
+  void Feed(std::string_view data);
+
+  /**
+   * @brief End the input, pretty output gets its final '\n'
+   *
+   */
+  void Finish();
+
+ private:
+  void FeedMinify(std::string_view data);
+  void FeedPretty(std::string_view data);
+  void Newline();
+
+  bool pretty_;
+  std::string* out_;
+  bool in_string_ = false;
+  bool escaped_ = false;
+  bool open_pending_ = false;
+  std::size_t depth_ = 0;
+};
+
+}  // namespace jpp
+
+#endif  // JSON_PARSER_INCLUDE_FORMATTER_H_
@@ -0,0 +1,115 @@
+/**
+ * @file incremental.h
+ * @author Mao Zhang (mao.zhang233@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef JSON_PARSER_INCLUDE_INCREMENTAL_H_
+#define JSON_PARSER_INCLUDE_INCREMENTAL_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "json.h"
+
+namespace jpp {
+
+/**
+ * @brief Text edit: removed bytes at offset (in the previous text) were
+ * replaced by inserted bytes
+ *
+ */
+struct Edit {
+  std::size_t offset;
+  std::size_t removed;
+  std::size_t inserted;
+};
+
+/**
+ * @brief Document that can be updated after small text edits. Every value
+ * remembers its source span, an edit re-parses only the smallest value that
+ * encloses it and keeps everything else.
+ *
+ */
+class IncrementalDocument {
+ public:
+  /**
+   * @brief Construct with parse options, lazy numbers are not supported
+   * since spans move around and the text is not kept
+   *
+   * @param options
+   */
+  explicit IncrementalDocument(const Options& options = Options{});
+
+  /**
+   * @brief Parse whole json
+   *
+   * @param json
+   * @return Result
+   */
+  Result Parse(const char* json);
+
+  /**
+   * @brief Update after edit, json is the whole new text. On error the
+   * document is left empty and the next call parses from scratch. Besides
+   * the re-parsed text, an edit costs a binary search per enclosing value
+   * and a shift of every sibling after it, O(n) in the size of the
+   * containers it sits in.
+   *
+   * @param json
+   * @param edit
+   * @return Result
+   */
+  Result Reparse(const char* json, const Edit& edit);
+
+  const Value& Root() const noexcept { return root_; }
+
+  /**
+   * @brief Get the number of bytes the last Parse or Reparse had to parse
+   *
+   * @return std::size_t
+   */
+  std::size_t ReparsedLength() const noexcept { return reparsed_length_; }
+
+ private:
+  // source span of a value, begin is relative to the enclosing value so
+  // an edit only shifts later siblings along its path, not their subtrees
+  struct Span {
+    std::size_t begin;
+    std::size_t length;
+    std::vector<Span> children;
+  };
+
+  // a node on the way from root down to the edited value
+  struct Step {
+    Span* span;
+    Value* value;
+    std::size_t begin;
+    std::size_t index;
+  };
+
+  /**
+   * @brief Build spans of the valid json value at text, its begin is set
+   * relative to text
+   *
+   * @param text
+   * @param span
+   */
+  static void BuildSpans(const char* text, Span* span);
+
+  Result ParseAll(const char* json);
+
+  Options options_;
+  Value root_;
+  Span span_;
+  bool valid_;
+  std::size_t reparsed_length_;
+};
+
+}  // namespace jpp
+
+#endif  // JSON_PARSER_INCLUDE_INCREMENTAL_H_
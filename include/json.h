@@ -11,26 +11,100 @@
 #ifndef JSON_PARSER_INCLUDE_JSON_H_
 #define JSON_PARSER_INCLUDE_JSON_H_
 
+#include <cstdint>
 #include <cstdlib>
 
+#ifndef JPP_PARSE_MAX_DEPTH
+#define JPP_PARSE_MAX_DEPTH 512
+#endif
+
 namespace jpp {
 
 enum class Type { Null, False, True, Number, String, Array, Object };
 
+class KeyPool;
+
 struct String {
   char* literal;
   std::size_t length;
+  // literal belongs to a KeyPool and is not freed with the value
+  bool interned;
+};
+
+/**
+ * @brief Number, either converted while parsing or kept as its source text
+ * and converted on first read (see Options::lazy_numbers)
+ *
+ */
+struct Number {
+  mutable double value;
+  // source text inside the parsed json, nullptr if not parsed lazily
+  const char* lexeme;
+  std::uint32_t length;
+  // value holds the converted lexeme
+  mutable bool converted;
 };
 
+struct Value;
+struct Member;
+
+struct Array {
+  Value* elements;
+  std::size_t size;
+};
+
+struct Object {
+  Member* members;
+  std::size_t size;
+};
+
+/**
+ * @brief Owning JSON value. Copying is disabled because a shallow copy would
+ * alias heap storage (e.g. string literal); use Clone() for a deep copy and
+ * std::move() to hand a value over without copying.
+ *
+ */
 struct Value {
+  Value() noexcept;
+  ~Value();
+
+  Value(const Value&) = delete;
+  Value& operator=(const Value&) = delete;
+
+  Value(Value&& other) noexcept;
+  Value& operator=(Value&& other) noexcept;
+
+  /**
+   * @brief Exchange contents with other value, never allocates
+   *
+   * @param other
+   */
+  void Swap(Value& other) noexcept;
+
+  /**
+   * @brief Deep copy of value
+   *
+   * @return Value
+   */
+  Value Clone() const;
+
   union {
     bool boolean;
-    double number;
+    Number number;
     String string;
+    Array array;
+    Object object;
   };
   Type type;
 };
 
+void swap(Value& lhs, Value& rhs) noexcept;
+
+struct Member {
+  String key;
+  Value value;
+};
+
 enum class Result {
   OK,
   ExpectValue,
@@ -39,7 +113,26 @@ enum class Result {
   NumberTooBig,
   MissingQuotationMark,
   InvalidStringEscape,
-  InvalidStringCharacter
+  InvalidStringCharacter,
+  MissingCommaOrSquareBracket,
+  MissingKey,
+  MissingColon,
+  MissingCommaOrCurlyBracket,
+  NestingTooDeep
+};
+
+struct Options {
+  // containers nested deeper than this fail with Result::NestingTooDeep.
+  // Parsing and every later walk over the value are iterative, so this only
+  // bounds memory, not native stack use.
+  std::size_t max_depth = JPP_PARSE_MAX_DEPTH;
+  // keep numbers as source text and convert them on first GetNumber, the
+  // json buffer must then outlive the parsed value. Range errors are not
+  // reported, an out of range number reads as HUGE_VAL.
+  bool lazy_numbers = false;
+  // intern object keys here so documents share key storage, the pool must
+  // outlive the parsed value. Keys the pool rejects are allocated as usual.
+  KeyPool* key_pool = nullptr;
 };
 
 struct Context {
@@ -47,10 +140,103 @@ struct Context {
   char* stack;
   std::size_t top;
   std::size_t size;
+  // offset of innermost open container frame in stack
+  std::size_t frame;
+  std::size_t depth;
+  std::size_t max_depth;
+  bool lazy_numbers;
+  KeyPool* key_pool;
+  // structural hash of the last parsed value, only kept when hashing is on
+  bool hashing;
+  std::uint64_t hash;
 };
 
+/**
+ * @brief Owning parse result holding the root value
+ *
+ */
+class Document {
+ public:
+  Document() = default;
+  ~Document() = default;
+
+  Document(const Document&) = delete;
+  Document& operator=(const Document&) = delete;
+
+  Document(Document&& other) noexcept = default;
+  Document& operator=(Document&& other) noexcept = default;
+
+  /**
+   * @brief Parse json into this document, previous root is released first
+   *
+   * @param json
+   * @return Result
+   */
+  Result Parse(const char* json);
+
+  /**
+   * @brief Parse json into this document with options
+   *
+   * @param json
+   * @param options
+   * @return Result
+   */
+  Result Parse(const char* json, const Options& options);
+
+  /**
+   * @brief Get the root value
+   *
+   * @return Value&
+   */
+  Value& Root() noexcept { return root_; }
+  const Value& Root() const noexcept { return root_; }
+
+  /**
+   * @brief Move root value out, document is left holding null
+   *
+   * @return Value
+   */
+  Value Release() noexcept;
+
+  /**
+   * @brief Structural hash of root, see JSON::Hash. Computed on every call,
+   * root can be changed through Root() at any time so nothing is cached.
+   *
+   * @return std::uint64_t
+   */
+  std::uint64_t Hash() const;
+
+  /**
+   * @brief Deep copy of document
+   *
+   * @return Document
+   */
+  Document Clone() const;
+
+  /**
+   * @brief Exchange contents with other document, never allocates
+   *
+   * @param other
+   */
+  void Swap(Document& other) noexcept;
+
+ private:
+  Value root_;
+};
+
+void swap(Document& lhs, Document& rhs) noexcept;
+
+/**
+ * @brief Deep equality of documents, same as JSON::Equal of their roots
+ *
+ */
+bool operator==(const Document& lhs, const Document& rhs);
+bool operator!=(const Document& lhs, const Document& rhs);
+
 class JSON {
  public:
+  static constexpr std::size_t kKeyNotExist = static_cast<std::size_t>(-1);
+
   JSON() = default;
   ~JSON() = default;
 
@@ -64,7 +250,34 @@ class JSON {
   static Result Parse(Value* value, const char* json);
 
   /**
-   *  @brief
+   *  @brief parse JSON and compute the structural hash of value on the way,
+   *  the result equals Hash(value)
+   *
+   *  @param value
+   *  @param json
+   *  @param hash can be nullptr
+   *  @return Result
+   */
+  static Result Parse(Value* value, const char* json, std::uint64_t* hash);
+
+  /**
+   *  @brief parse JSON with options
+   *
+   *  @param value
+   *  @param json
+   *  @param options
+   *  @param hash can be nullptr
+   *  @return Result
+   */
+  static Result Parse(Value* value, const char* json, const Options& options,
+                      std::uint64_t* hash = nullptr);
+
+  /**
+   *  @brief value = false / null / true / object / array / number / string
+   *
+   *  Iterative: open containers are kept as frames on the context stack
+   *  instead of the native call stack, so nesting is bounded only by
+   *  context->max_depth. Dispatch goes through a 256-entry byte class table.
    *
    *  @param context
    *  @param value
@@ -138,6 +351,18 @@ class JSON {
   */
   static Result ParseString(Context* context, Value* value);
 
+  /**
+   *  @brief Parse string body into context stack, str points into the stack
+   *  and is only valid until the next push
+   *
+   *  @param context
+   *  @param str
+   *  @param length
+   *  @return Result
+   */
+  static Result ParseStringRaw(Context* context, char** str,
+                               std::size_t* length);
+
   /**
    *  @brief Push into context stack
    *
@@ -171,6 +396,77 @@ class JSON {
    */
   static void FreeValue(Value* value);
 
+  /**
+   * @brief Deep copy src into dst, dst is freed first
+   *
+   * @param dst
+   * @param src
+   */
+  static void CopyValue(Value* dst, const Value* src);
+
+  /**
+   * @brief Move src into dst without copying, src is left as null. src may
+   * live inside dst, e.g. to replace an array by one of its elements.
+   *
+   * @param dst
+   * @param src
+   */
+  static void MoveValue(Value* dst, Value* src) noexcept;
+
+  /**
+   * @brief Exchange contents of lhs and rhs. Neither may live inside the
+   * other, a value cannot hold itself, use MoveValue to replace a value by
+   * one of its children.
+   *
+   * @param lhs
+   * @param rhs
+   */
+  static void SwapValue(Value* lhs, Value* rhs) noexcept;
+
+  /**
+   * @brief Generate compact JSON text from value. Lazy numbers are written
+   * as their original text, byte for byte.
+   *
+   * @param value
+   * @param length can be nullptr
+   * @return char* allocated with malloc, null terminated, freed by caller
+   */
+  static char* Stringify(const Value* value, std::size_t* length);
+
+  /**
+   * @brief Structural hash of value (non-cryptographic). Independent of
+   * whitespace and of member order in objects, so semantically equal values
+   * hash equal.
+   *
+   * @param value
+   * @return std::uint64_t
+   */
+  static std::uint64_t Hash(const Value* value);
+
+  /**
+   * @brief Deep equality, member order in objects is ignored. Members with
+   * the same key are compared in their order of appearance.
+   *
+   * @param lhs
+   * @param rhs
+   * @return bool
+   */
+  static bool Equal(const Value* lhs, const Value* rhs);
+
+  /**
+   * @brief Deep equality when the hashes of both sides are known already,
+   * e.g. from Parse or FrozenDocument::Hash. Different hashes reject right
+   * away, only equal ones are compared value by value.
+   *
+   * @param lhs
+   * @param lhs_hash Hash(lhs)
+   * @param rhs
+   * @param rhs_hash Hash(rhs)
+   * @return bool
+   */
+  static bool Equal(const Value* lhs, std::uint64_t lhs_hash,
+                    const Value* rhs, std::uint64_t rhs_hash);
+
   /**
    *  @brief Get the Type of value
    *
@@ -203,13 +499,35 @@ class JSON {
   static void SetBoolean(Value* value, bool boolean);
 
   /**
-   *  @brief Get the Number from value
+   *  @brief Get the Number from value, a lazy number is converted on first
+   *  call and cached
    *
    *  @param value
    *  @return double
    */
   static double GetNumber(const Value* value);
 
+  /**
+   *  @brief Get the Number from value as integer. Integer lexemes of lazy
+   *  numbers are converted exactly, otherwise the double is truncated and
+   *  clamped to the int64 range. The conversion is cached like GetNumber,
+   *  but integers of magnitude 2^53 and above are read from the lexeme on
+   *  every call, a double cannot hold them exactly.
+   *
+   *  @param value
+   *  @return std::int64_t
+   */
+  static std::int64_t GetInt64(const Value* value);
+
+  /**
+   *  @brief Get the source text of a lazily parsed number
+   *
+   *  @param value
+   *  @param length
+   *  @return const char* or nullptr if number was not parsed lazily
+   */
+  static const char* GetNumberLexeme(const Value* value, std::size_t* length);
+
   /**
    * @brief Set the Number object
    *
@@ -243,7 +561,168 @@ class JSON {
    */
   static void SetString(Value* value, const char* str, std::size_t length);
 
+  /**
+   *  @brief Get the number of elements in array
+   *
+   *  @param value
+   *  @return std::size_t
+   */
+  static std::size_t GetArraySize(const Value* value);
+
+  /**
+   *  @brief Get the element of array at index
+   *
+   *  @param value
+   *  @param index
+   *  @return Value*
+   */
+  static const Value* GetArrayElement(const Value* value, std::size_t index);
+  static Value* GetArrayElement(Value* value, std::size_t index);
+
+  /**
+   *  @brief Get the number of members in object
+   *
+   *  @param value
+   *  @return std::size_t
+   */
+  static std::size_t GetObjectSize(const Value* value);
+
+  /**
+   *  @brief Get the key of object member at index
+   *
+   *  @param value
+   *  @param index
+   *  @return const char*
+   */
+  static const char* GetObjectKey(const Value* value, std::size_t index);
+
+  /**
+   *  @brief Get the key length of object member at index
+   *
+   *  @param value
+   *  @param index
+   *  @return std::size_t
+   */
+  static std::size_t GetObjectKeyLength(const Value* value, std::size_t index);
+
+  /**
+   *  @brief Get the value of object member at index
+   *
+   *  @param value
+   *  @param index
+   *  @return Value*
+   */
+  static const Value* GetObjectValue(const Value* value, std::size_t index);
+  static Value* GetObjectValue(Value* value, std::size_t index);
+
+  /**
+   *  @brief Find index of first member with key
+   *
+   *  @param value
+   *  @param key
+   *  @param length
+   *  @return std::size_t index or kKeyNotExist
+   */
+  static std::size_t FindObjectIndex(const Value* value, const char* key,
+                                     std::size_t length);
+
+  /**
+   *  @brief Find value of first member with key
+   *
+   *  @param value
+   *  @param key
+   *  @param length
+   *  @return Value* or nullptr
+   */
+  static const Value* FindObjectValue(const Value* value, const char* key,
+                                      std::size_t length);
+
+  /**
+   *  @brief Find index of first member with key, where key was returned by
+   *  the KeyPool value was parsed with. Interned member keys are matched by
+   *  address only.
+   *
+   *  @param value
+   *  @param key
+   *  @param length
+   *  @return std::size_t index or kKeyNotExist
+   */
+  static std::size_t FindInternedObjectIndex(const Value* value,
+                                             const char* key,
+                                             std::size_t length);
+
  private:
+  /**
+   *  @brief member = string name-separator value, parses the key part up to
+   *  and including the name separator and pushes the member
+   *
+   *  @param context
+   *  @return Result
+   */
+  static Result ParseMemberKey(Context* context);
+
+  /**
+   *  @brief Push a frame for a new array or object onto context stack
+   *
+   *  @param context
+   *  @param type
+   *  @return Result
+   */
+  static Result ContextOpen(Context* context, Type type);
+
+  /**
+   *  @brief Pop innermost array frame and move its elements into value
+   *
+   *  @param context
+   *  @param value
+   */
+  static void ContextCloseArray(Context* context, Value* value);
+
+  /**
+   *  @brief Pop innermost object frame and move its members into value
+   *
+   *  @param context
+   *  @param value
+   */
+  static void ContextCloseObject(Context* context, Value* value);
+
+  /**
+   *  @brief Pop and free every frame above frame_offset after an error
+   *
+   *  @param context
+   *  @param frame_offset
+   */
+  static void ContextUnwind(Context* context, std::size_t frame_offset);
+
+  /**
+   *  @brief Append JSON text of value to context stack
+   *
+   *  @param context
+   *  @param value
+   */
+  static void StringifyValue(Context* context, const Value* value);
+
+  /**
+   *  @brief Append quoted and escaped string to context stack
+   *
+   *  @param context
+   *  @param str
+   *  @param length
+   */
+  static void StringifyString(Context* context, const char* str,
+                              std::size_t length);
+
+  /**
+   *  @brief Pair every member of object lhs with one of object rhs (same
+   *  size) by key, the pairs are pushed to pairs as size_t indices into rhs.
+   *  O(n) for members in the same order, O(n log n) otherwise.
+   *
+   *  @param pairs
+   *  @param lhs
+   *  @param rhs
+   *  @return false if some key has no partner, nothing is pushed then
+   */
+  static bool PairMembers(Context* pairs, const Value* lhs, const Value* rhs);
 };
 
 }  // namespace jpp
@@ -0,0 +1,92 @@
+/**
+ * @file key_pool.h
+ * @author Mao Zhang (mao.zhang233@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef JSON_PARSER_INCLUDE_KEY_POOL_H_
+#define JSON_PARSER_INCLUDE_KEY_POOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_set>
+
+#ifndef JPP_KEY_POOL_MAX_KEYS
+#define JPP_KEY_POOL_MAX_KEYS 4096
+#endif
+
+#ifndef JPP_KEY_POOL_MAX_KEY_LENGTH
+#define JPP_KEY_POOL_MAX_KEY_LENGTH 64
+#endif
+
+namespace jpp {
+
+/**
+ * @brief Bounded, thread-safe pool of object keys shared across documents.
+ * Every key is stored once and keeps its address until the pool is
+ * destroyed, so the pool must outlive every value parsed with it.
+ *
+ */
+class KeyPool {
+ public:
+  explicit KeyPool(std::size_t max_keys = JPP_KEY_POOL_MAX_KEYS,
+                   std::size_t max_key_length = JPP_KEY_POOL_MAX_KEY_LENGTH);
+  ~KeyPool();
+
+  KeyPool(const KeyPool&) = delete;
+  KeyPool& operator=(const KeyPool&) = delete;
+
+  /**
+   * @brief Get the interned copy of key, adding it if absent
+   *
+   * @param key
+   * @param length
+   * @return const char* null terminated, or nullptr if pool is full or key
+   * is longer than max key length
+   */
+  const char* Intern(const char* key, std::size_t length);
+
+  /**
+   * @brief Get the interned copy of key without adding it
+   *
+   * @param key
+   * @param length
+   * @return const char* or nullptr
+   */
+  const char* Find(const char* key, std::size_t length) const;
+
+  /**
+   * @brief Get the number of interned keys
+   *
+   * @return std::size_t
+   */
+  std::size_t Size() const noexcept;
+
+ private:
+  static constexpr std::size_t kShardCount = 16;
+  static constexpr std::size_t kShardShift = sizeof(std::size_t) * 8 - 8;
+
+  // readers of different shards never touch the same lock
+  struct alignas(64) Shard {
+    mutable std::shared_mutex mutex;
+    std::unordered_set<std::string_view> keys;
+  };
+
+  Shard& ShardOf(std::size_t hash) noexcept;
+  const Shard& ShardOf(std::size_t hash) const noexcept;
+
+  Shard shards_[kShardCount];
+  std::atomic<std::size_t> size_;
+  const std::size_t max_keys_;
+  const std::size_t max_key_length_;
+};
+
+}  // namespace jpp
+
+#endif  // JSON_PARSER_INCLUDE_KEY_POOL_H_
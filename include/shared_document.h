@@ -0,0 +1,210 @@
+/**
+ * @file shared_document.h
+ * @author Mao Zhang (mao.zhang233@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef JSON_PARSER_INCLUDE_SHARED_DOCUMENT_H_
+#define JSON_PARSER_INCLUDE_SHARED_DOCUMENT_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "json.h"
+
+#ifndef JPP_SHARED_DOCUMENT_MAX_READERS
+#define JPP_SHARED_DOCUMENT_MAX_READERS 128
+#endif
+
+namespace jpp {
+
+/**
+ * @brief Read-only document. Lazy numbers are converted and the hash is
+ * computed when frozen, so reading never writes and any number of threads
+ * may read at once.
+ *
+ */
+class FrozenDocument {
+ public:
+  /**
+   * @brief Freeze document, lazy numbers are detached from their source
+   * text so the snapshot does not depend on the parsed buffer
+   *
+   * @param document
+   */
+  explicit FrozenDocument(Document&& document);
+
+  FrozenDocument(const FrozenDocument&) = delete;
+  FrozenDocument& operator=(const FrozenDocument&) = delete;
+
+  const Value& Root() const noexcept { return document_.Root(); }
+  std::uint64_t Hash() const noexcept { return hash_; }
+
+ private:
+  friend class SharedDocument;
+
+  FrozenDocument() = default;
+
+  /**
+   * @brief Convert every lazy number, optionally dropping its source text
+   *
+   * @param detach
+   */
+  void Freeze(bool detach);
+
+  // parsed text, kept for lazy number passthrough
+  std::string source_;
+  Document document_;
+  std::uint64_t hash_ = 0;
+};
+
+/**
+ * @brief Deep equality of snapshots, their hashes known since freezing
+ * reject most unequal ones without comparing values
+ *
+ */
+bool operator==(const FrozenDocument& lhs, const FrozenDocument& rhs);
+bool operator!=(const FrozenDocument& lhs, const FrozenDocument& rhs);
+
+/**
+ * @brief Atomically replaceable FrozenDocument. Readers pin the current
+ * snapshot with a hazard pointer: no locks and no waiting on writers.
+ * Readers never delete anything, a replaced snapshot is deleted by the
+ * first Store, Load or Reclaim that finds it no longer pinned.
+ *
+ */
+class SharedDocument {
+ public:
+  /**
+   * @brief Keeps a snapshot alive, release it quickly
+   *
+   */
+  class Guard {
+   public:
+    Guard() = default;
+    ~Guard();
+
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+
+    Guard(Guard&& other) noexcept;
+    Guard& operator=(Guard&& other) noexcept;
+
+    const FrozenDocument* Get() const noexcept { return document_; }
+    const FrozenDocument* operator->() const noexcept { return document_; }
+    const FrozenDocument& operator*() const noexcept { return *document_; }
+    explicit operator bool() const noexcept { return document_ != nullptr; }
+
+    /**
+     * @brief Unpin the snapshot before the guard goes away
+     *
+     */
+    void Reset() noexcept;
+
+   private:
+    friend class SharedDocument;
+
+    Guard(SharedDocument* owner, std::size_t slot,
+          const FrozenDocument* document) noexcept
+        : owner_(owner), slot_(slot), document_(document) {}
+
+    SharedDocument* owner_ = nullptr;
+    std::size_t slot_ = 0;
+    const FrozenDocument* document_ = nullptr;
+  };
+
+  /**
+   * @brief Construct empty, max_readers is the number of guards that can
+   * be held at the same time before Pin starts to spin
+   *
+   * @param max_readers
+   */
+  explicit SharedDocument(
+      std::size_t max_readers = JPP_SHARED_DOCUMENT_MAX_READERS);
+
+  /**
+   * @brief Destroy every snapshot, no guard may be alive anymore
+   *
+   */
+  ~SharedDocument();
+
+  SharedDocument(const SharedDocument&) = delete;
+  SharedDocument& operator=(const SharedDocument&) = delete;
+
+  /**
+   * @brief Pin the current snapshot, lock-free
+   *
+   * @return Guard empty if nothing was published yet
+   */
+  Guard Pin();
+
+  /**
+   * @brief Publish document as the new snapshot
+   *
+   * @param document
+   */
+  void Store(Document&& document);
+
+  /**
+   * @brief Parse json and publish it, the current snapshot is kept when
+   * parsing fails
+   *
+   * @param json
+   * @param options
+   * @return Result
+   */
+  Result Load(const char* json, const Options& options = Options{});
+
+  /**
+   * @brief Delete replaced snapshots no reader pins anymore. Call it from
+   * a writer or background thread now and then, a snapshot unpinned after
+   * the last Store or Load is not deleted otherwise.
+   *
+   */
+  void Reclaim();
+
+  /**
+   * @brief Get the number of replaced snapshots not deleted yet
+   *
+   * @return std::size_t
+   */
+  std::size_t RetiredCount();
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<bool> used{false};
+    std::atomic<const FrozenDocument*> hazard{nullptr};
+  };
+
+  void Publish(const FrozenDocument* document);
+  void Release(std::size_t slot) noexcept;
+
+  /**
+   * @brief Take the replaced snapshots no reader pins anymore out of
+   * retired_, the caller deletes them after unlocking mutex_
+   *
+   * @return std::vector<const FrozenDocument*>
+   */
+  std::vector<const FrozenDocument*> TakeUnpinnedLocked();
+
+  std::atomic<const FrozenDocument*> current_;
+  std::unique_ptr<Slot[]> slots_;
+  std::size_t slot_count_;
+
+  // writers and reclamation only, readers never wait on it
+  std::mutex mutex_;
+  std::vector<const FrozenDocument*> retired_;
+};
+
+}  // namespace jpp
+
+#endif  // JSON_PARSER_INCLUDE_SHARED_DOCUMENT_H_
@@ -0,0 +1,703 @@
+/**
+ * @file columnar.cc
+ * @author Mao Zhang (mao.zhang233@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "columnar.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <utility>
+
+#include "json.h"
+
+#define ISDIGIT(character) ((character) >= '0' && (character) <= '9')
+
+#define ISDIGIT1TO9(character) ((character) >= '1' && (character) <= '9')
+
+namespace jpp {
+
+namespace {
+
+constexpr std::size_t kNoNode = std::numeric_limits<std::size_t>::max();
+
+// '\n' ends a record, so it never counts as whitespace inside one
+inline bool IsSpace(char character) {
+  return character == ' ' || character == '\t' || character == '\r';
+}
+
+inline const char* SkipSpace(const char* p) {
+  while (IsSpace(*p)) {
+    ++p;
+  }
+
+  return p;
+}
+
+// p points at the opening quotation mark, returns just behind the closing
+// one or nullptr if the string is not terminated on this line
+const char* SkipString(const char* p) {
+  for (++p;; ++p) {
+    unsigned char character = static_cast<unsigned char>(*p);
+    if (character == '\"') {
+      return p + 1;
+    }
+    if (character == '\\') {
+      ++p;
+      character = static_cast<unsigned char>(*p);
+    }
+    if (character < 0x20) {
+      return nullptr;
+    }
+  }
+}
+
+// same grammar the parser accepts, returns the end of the number or nullptr
+const char* ScanNumber(const char* p) {
+  if (*p == '-') {
+    ++p;
+  }
+  if (*p == '0') {
+    ++p;
+  } else {
+    if (!ISDIGIT1TO9(*p)) {
+      return nullptr;
+    }
+
+    do {
+      ++p;
+    } while (ISDIGIT(*p));
+  }
+  if (*p == '.') {
+    ++p;
+
+    if (!ISDIGIT(*p)) {
+      return nullptr;
+    }
+
+    do {
+      ++p;
+    } while (ISDIGIT(*p));
+  }
+  if (*p == 'e' || *p == 'E') {
+    ++p;
+
+    if (*p == '+' || *p == '-') {
+      ++p;
+    }
+
+    if (!ISDIGIT(*p)) {
+      return nullptr;
+    }
+
+    do {
+      ++p;
+    } while (ISDIGIT(*p));
+  }
+
+  return p;
+}
+
+// p points at a member key, returns the start of its value or nullptr
+const char* SkipKey(const char* p) {
+  if (*p != '\"') {
+    return nullptr;
+  }
+
+  p = SkipString(p);
+  if (p == nullptr) {
+    return nullptr;
+  }
+
+  p = SkipSpace(p);
+  if (*p != ':') {
+    return nullptr;
+  }
+
+  return SkipSpace(p + 1);
+}
+
+// skip the value at p without converting anything, brackets holds the
+// closing bracket of every open container
+const char* SkipValue(const char* p, std::string* brackets) {
+  brackets->clear();
+
+  for (;;) {
+    // p is at the start of a value
+    if (*p == '[' || *p == '{') {
+      char close = *p == '[' ? ']' : '}';
+      p = SkipSpace(p + 1);
+      if (*p == close) {
+        ++p;
+      } else {
+        if (brackets->size() >= JPP_PARSE_MAX_DEPTH) {
+          return nullptr;
+        }
+        brackets->push_back(close);
+        if (close == '}' && (p = SkipKey(p)) == nullptr) {
+          return nullptr;
+        }
+        continue;
+      }
+    } else if (*p == '\"') {
+      p = SkipString(p);
+    } else if (*p == 't') {
+      p = std::strncmp(p, "true", 4) == 0 ? p + 4 : nullptr;
+    } else if (*p == 'f') {
+      p = std::strncmp(p, "false", 5) == 0 ? p + 5 : nullptr;
+    } else if (*p == 'n') {
+      p = std::strncmp(p, "null", 4) == 0 ? p + 4 : nullptr;
+    } else {
+      p = ScanNumber(p);
+    }
+    if (p == nullptr) {
+      return nullptr;
+    }
+
+    // close every container the value completes
+    for (;;) {
+      if (brackets->empty()) {
+        return p;
+      }
+
+      p = SkipSpace(p);
+      if (*p == ',') {
+        p = SkipSpace(p + 1);
+        if (brackets->back() == '}' && (p = SkipKey(p)) == nullptr) {
+          return nullptr;
+        }
+        break;
+      }
+      if (*p != brackets->back()) {
+        return nullptr;
+      }
+
+      ++p;
+      brackets->pop_back();
+    }
+  }
+}
+
+// count row in, valid or null
+inline void AddRow(Column* column, bool valid) {
+  if (column->size % 64 == 0) {
+    column->validity.push_back(0);
+  }
+  if (valid) {
+    column->validity.back() |= std::uint64_t{1} << (column->size % 64);
+  } else {
+    ++column->null_count;
+  }
+  ++column->size;
+}
+
+void AddNull(Column* column) {
+  switch (column->type) {
+    case ColumnType::Double:
+      column->doubles.push_back(0.0);
+      break;
+    case ColumnType::Int64:
+      column->int64s.push_back(0);
+      break;
+    case ColumnType::String:
+      column->offsets.push_back(column->bytes.size());
+      break;
+    case ColumnType::Boolean:
+      column->booleans.push_back(0);
+      break;
+  }
+  AddRow(column, false);
+}
+
+// drop the last row, which must be a valid one
+void RemoveRow(Column* column) {
+  --column->size;
+  column->validity.back() &= ~(std::uint64_t{1} << (column->size % 64));
+  if (column->size % 64 == 0) {
+    column->validity.pop_back();
+  }
+
+  switch (column->type) {
+    case ColumnType::Double:
+      column->doubles.pop_back();
+      break;
+    case ColumnType::Int64:
+      column->int64s.pop_back();
+      break;
+    case ColumnType::String:
+      column->offsets.pop_back();
+      column->bytes.resize(column->offsets.back());
+      break;
+    case ColumnType::Boolean:
+      column->booleans.pop_back();
+      break;
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief Scans the records of one piece of a batch into its own columns,
+ * all state is reused from record to record
+ *
+ */
+class ColumnExtractor::Scanner {
+ public:
+  Scanner(const ColumnExtractor& extractor, std::vector<Column>* columns)
+      : nodes_(extractor.nodes_),
+        columns_(columns),
+        filled_(columns->size()),
+        seen_(extractor.nodes_.size()) {}
+
+  /**
+   * @brief Scan the lines in [begin, end), end is right behind a '\n' or at
+   * the terminating '\0'
+   *
+   * @param begin
+   * @param end
+   * @return std::size_t number of records that could not be scanned
+   */
+  std::size_t Run(const char* begin, const char* end) {
+    std::size_t invalid = 0;
+
+    const char* p = begin;
+    while (p < end) {
+      p = SkipSpace(p);
+      if (*p == '\n') {
+        ++p;
+        continue;
+      }
+      if (*p == '\0') {
+        break;
+      }
+
+      std::fill(filled_.begin(), filled_.end(), 0);
+      const char* q = Record(p);
+      if (q != nullptr) {
+        q = SkipSpace(q);
+        if (*q != '\n' && *q != '\0') {
+          q = nullptr;
+        }
+      }
+
+      // a broken record must not leave half of its fields behind
+      for (std::size_t i = 0; i < filled_.size(); ++i) {
+        if (q == nullptr && filled_[i]) {
+          RemoveRow(&(*columns_)[i]);
+        }
+        if (q == nullptr || !filled_[i]) {
+          AddNull(&(*columns_)[i]);
+        }
+      }
+      if (q == nullptr) {
+        ++invalid;
+        const void* newline = std::memchr(p, '\n', end - p);
+        q = newline != nullptr ? static_cast<const char*>(newline) : end;
+      }
+
+      p = q < end ? q + 1 : end;
+    }
+
+    return invalid;
+  }
+
+ private:
+  std::size_t FindChild(std::size_t node, const char* key,
+                        std::size_t length) const {
+    for (std::size_t child : nodes_[node].children) {
+      const std::string& name = nodes_[child].key;
+      if (name.size() == length && std::memcmp(name.data(), key, length) == 0) {
+        return child;
+      }
+    }
+
+    return kNoNode;
+  }
+
+  // returns the end of the record at p, or nullptr
+  const char* Record(const char* p) {
+    if (*p != '{') {
+      // no field can match, every column stays null
+      return SkipValue(p, &brackets_);
+    }
+
+    stack_.assign(1, 0);
+    std::fill(seen_.begin(), seen_.end(), 0);
+    p = SkipSpace(p + 1);
+    if (*p == '}') {
+      return p + 1;
+    }
+
+    for (;;) {
+      // p is at a member key
+      if (*p != '\"') {
+        return nullptr;
+      }
+      const char* key = p + 1;
+      p = SkipString(p);
+      if (p == nullptr) {
+        return nullptr;
+      }
+      std::size_t length = static_cast<std::size_t>(p - 1 - key);
+
+      p = SkipSpace(p);
+      if (*p != ':') {
+        return nullptr;
+      }
+      p = SkipSpace(p + 1);
+
+      // like JSON::FindObjectValue only the first occurrence of a key
+      // counts, whatever its value, later ones are skipped. A node is
+      // reached through the first occurrence of its parent only, so one
+      // mark per record is enough.
+      std::size_t child = FindChild(stack_.back(), key, length);
+      if (child != kNoNode) {
+        if (seen_[child]) {
+          child = kNoNode;
+        } else {
+          seen_[child] = 1;
+        }
+      }
+      if (child != kNoNode && *p == '{' && !nodes_[child].children.empty()) {
+        if (stack_.size() >= JPP_PARSE_MAX_DEPTH) {
+          return nullptr;
+        }
+        stack_.push_back(child);
+        p = SkipSpace(p + 1);
+        if (*p != '}') {
+          continue;
+        }
+        ++p;
+        stack_.pop_back();
+      } else if (child != kNoNode && !nodes_[child].columns.empty()) {
+        const char* end = nullptr;
+        for (std::size_t column : nodes_[child].columns) {
+          end = Store(column, p);
+          if (end == nullptr) {
+            return nullptr;
+          }
+        }
+        p = end;
+      } else {
+        p = SkipValue(p, &brackets_);
+        if (p == nullptr) {
+          return nullptr;
+        }
+      }
+
+      // close every object the value completes
+      for (;;) {
+        p = SkipSpace(p);
+        if (*p == ',') {
+          p = SkipSpace(p + 1);
+          break;
+        }
+        if (*p != '}') {
+          return nullptr;
+        }
+
+        ++p;
+        stack_.pop_back();
+        if (stack_.empty()) {
+          return p;
+        }
+      }
+    }
+  }
+
+  // append value at p to column if its type fits, returns end of the value
+  const char* Store(std::size_t index, const char* p) {
+    Column* column = &(*columns_)[index];
+
+    switch (column->type) {
+      case ColumnType::Double:
+      case ColumnType::Int64:
+        if (*p == '-' || ISDIGIT(*p)) {
+          return StoreNumber(index, p);
+        }
+        break;
+      case ColumnType::String:
+        if (*p == '\"') {
+          return StoreString(index, p);
+        }
+        break;
+      case ColumnType::Boolean:
+        if (std::strncmp(p, "true", 4) == 0 ||
+            std::strncmp(p, "false", 5) == 0) {
+          column->booleans.push_back(*p == 't');
+          AddRow(column, true);
+          filled_[index] = 1;
+          return p + (*p == 't' ? 4 : 5);
+        }
+        break;
+    }
+
+    return SkipValue(p, &brackets_);
+  }
+
+  const char* StoreNumber(std::size_t index, const char* p) {
+    Column* column = &(*columns_)[index];
+    const char* end = ScanNumber(p);
+    if (end == nullptr) {
+      return nullptr;
+    }
+
+    bool integer = true;
+    for (const char* q = p; q != end; ++q) {
+      if (!ISDIGIT(*q) && *q != '-') {
+        integer = false;
+        break;
+      }
+    }
+
+    // exact even beyond 2^53, saturates on overflow like JSON::GetInt64
+    if (column->type == ColumnType::Int64 && integer) {
+      column->int64s.push_back(strtoll(p, nullptr, 10));
+      AddRow(column, true);
+      filled_[index] = 1;
+      return end;
+    }
+
+    errno = 0;
+    double number = strtod(p, nullptr);
+    if (errno == ERANGE || number == HUGE_VAL || number == -HUGE_VAL) {
+      // out of range, left null just like the parser rejects it
+      return end;
+    }
+
+    if (column->type == ColumnType::Double) {
+      column->doubles.push_back(number);
+    } else if (number >= 9223372036854775807.0) {
+      column->int64s.push_back(std::numeric_limits<std::int64_t>::max());
+    } else if (number <= -9223372036854775808.0) {
+      column->int64s.push_back(std::numeric_limits<std::int64_t>::min());
+    } else {
+      column->int64s.push_back(static_cast<std::int64_t>(number));
+    }
+    AddRow(column, true);
+    filled_[index] = 1;
+
+    return end;
+  }
+
+  const char* StoreString(std::size_t index, const char* p) {
+    Column* column = &(*columns_)[index];
+    std::vector<char>& bytes = column->bytes;
+
+    const char* q = p + 1;
+    for (;;) {
+      // copy runs without escapes at once
+      const char* run = q;
+      while (*q != '\"' && *q != '\\' &&
+             static_cast<unsigned char>(*q) >= 0x20) {
+        ++q;
+      }
+      bytes.insert(bytes.end(), run, q);
+      if (*q == '\"') {
+        break;
+      }
+
+      char character = '\0';
+      if (*q == '\\') {
+        switch (q[1]) {
+          case '\"':
+          case '\\':
+          case '/':
+            character = q[1];
+            break;
+          case 'b':
+            character = '\b';
+            break;
+          case 'f':
+            character = '\f';
+            break;
+          case 'n':
+            character = '\n';
+            break;
+          case 'r':
+            character = '\r';
+            break;
+          case 't':
+            character = '\t';
+            break;
+          default:
+            break;
+        }
+      }
+      if (character == '\0') {
+        bytes.resize(column->offsets.back());
+        return nullptr;
+      }
+      bytes.push_back(character);
+      q += 2;
+    }
+
+    column->offsets.push_back(bytes.size());
+    AddRow(column, true);
+    filled_[index] = 1;
+
+    return q + 1;
+  }
+
+  const std::vector<PathNode>& nodes_;
+  std::vector<Column>* columns_;
+  // whether a column got its row of the current record already
+  std::vector<std::uint8_t> filled_;
+  // whether a path node's key occurred in the current record already
+  std::vector<std::uint8_t> seen_;
+  std::vector<std::size_t> stack_;
+  std::string brackets_;
+};
+
+Column::Column(ColumnType type) : type(type), size(0), null_count(0) {
+  if (type == ColumnType::String) {
+    offsets.push_back(0);
+  }
+}
+
+void Column::Append(const Column& other) {
+  assert(type == other.type);
+
+  // other starts at bit size % 64 of a word, bits behind a column's last
+  // row are always clear so words can be or-ed in
+  std::size_t base = size / 64;
+  std::size_t shift = size % 64;
+  validity.resize((size + other.size + 63) / 64, 0);
+  for (std::size_t i = 0; i < other.validity.size(); ++i) {
+    validity[base + i] |= other.validity[i] << shift;
+    if (shift != 0 && base + i + 1 < validity.size()) {
+      validity[base + i + 1] |= other.validity[i] >> (64 - shift);
+    }
+  }
+
+  switch (type) {
+    case ColumnType::Double:
+      doubles.insert(doubles.end(), other.doubles.begin(),
+                     other.doubles.end());
+      break;
+    case ColumnType::Int64:
+      int64s.insert(int64s.end(), other.int64s.begin(), other.int64s.end());
+      break;
+    case ColumnType::String: {
+      std::uint64_t offset = bytes.size();
+      offsets.reserve(offsets.size() + other.size);
+      for (std::size_t i = 1; i < other.offsets.size(); ++i) {
+        offsets.push_back(offset + other.offsets[i]);
+      }
+      bytes.insert(bytes.end(), other.bytes.begin(), other.bytes.end());
+      break;
+    }
+    case ColumnType::Boolean:
+      booleans.insert(booleans.end(), other.booleans.begin(),
+                      other.booleans.end());
+      break;
+  }
+
+  size += other.size;
+  null_count += other.null_count;
+}
+
+ColumnExtractor::ColumnExtractor(std::vector<ColumnSpec> specs,
+                                 unsigned threads)
+    : specs_(std::move(specs)), nodes_(1), threads_(threads > 0 ? threads : 1) {
+  for (std::size_t i = 0; i < specs_.size(); ++i) {
+    std::string_view path = specs_[i].path;
+    std::size_t node = 0;
+
+    for (;;) {
+      std::size_t dot = path.find('.');
+      std::string_view key = path.substr(0, dot);
+
+      std::size_t child = kNoNode;
+      for (std::size_t candidate : nodes_[node].children) {
+        if (nodes_[candidate].key == key) {
+          child = candidate;
+          break;
+        }
+      }
+      if (child == kNoNode) {
+        child = nodes_.size();
+        nodes_.push_back(PathNode{std::string(key), {}, {}});
+        nodes_[node].children.push_back(child);
+      }
+      node = child;
+
+      if (dot == std::string_view::npos) {
+        break;
+      }
+      path.remove_prefix(dot + 1);
+    }
+
+    nodes_[node].columns.push_back(i);
+  }
+}
+
+std::size_t ColumnExtractor::Extract(const char* ndjson,
+                                     std::vector<Column>* columns) const {
+  assert(ndjson != nullptr && columns != nullptr);
+
+  if (columns->empty()) {
+    for (const ColumnSpec& spec : specs_) {
+      columns->emplace_back(spec.type);
+    }
+  }
+  assert(columns->size() == specs_.size());
+
+  // cut batch into a piece per thread, each ending right behind a '\n'
+  std::size_t length = std::strlen(ndjson);
+  const char* last = ndjson + length;
+  std::vector<const char*> bounds{ndjson};
+  for (unsigned i = 1; i < threads_; ++i) {
+    const char* cut = std::max(ndjson + length / threads_ * i, bounds.back());
+    const void* newline = std::memchr(cut, '\n', last - cut);
+    if (newline == nullptr) {
+      break;
+    }
+    bounds.push_back(static_cast<const char*>(newline) + 1);
+  }
+  bounds.push_back(last);
+
+  // first piece goes straight into columns, the others are appended in order
+  std::size_t pieces = bounds.size() - 1;
+  std::vector<std::vector<Column>> locals(pieces - 1);
+  std::vector<std::size_t> invalid(pieces, 0);
+  std::vector<std::thread> threads;
+  for (std::size_t i = 1; i < pieces; ++i) {
+    threads.emplace_back([this, &bounds, &locals, &invalid, i]() {
+      std::vector<Column>& local = locals[i - 1];
+      for (const ColumnSpec& spec : specs_) {
+        local.emplace_back(spec.type);
+      }
+      Scanner scanner(*this, &local);
+      invalid[i] = scanner.Run(bounds[i], bounds[i + 1]);
+    });
+  }
+  Scanner scanner(*this, columns);
+  invalid[0] = scanner.Run(bounds[0], bounds[1]);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  std::size_t total = invalid[0];
+  for (std::size_t i = 1; i < pieces; ++i) {
+    for (std::size_t j = 0; j < columns->size(); ++j) {
+      (*columns)[j].Append(locals[i - 1][j]);
+    }
+    total += invalid[i];
+  }
+
+  return total;
+}
+
+}  // namespace jpp
@@ -0,0 +1,424 @@
+/**
+ * @file decompress_reader.cc
+ * @author Mao Zhang (mao.zhang233@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "decompress_reader.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+#ifdef JPP_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef JPP_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace jpp {
+
+namespace {
+
+// smallest amount asked from a source at once
+constexpr std::size_t kMinRead = 1 << 16;
+
+}  // namespace
+
+/**
+ * @brief Stream of decompressed bytes, used by the producer thread only
+ *
+ */
+class DecompressSource {
+ public:
+  virtual ~DecompressSource() = default;
+
+  /**
+   * @brief Decompress up to capacity bytes into out
+   *
+   * @param out
+   * @param capacity
+   * @param error set on failure
+   * @return std::size_t bytes written, 0 at end of input or on failure
+   */
+  virtual std::size_t Read(char* out, std::size_t capacity,
+                           std::string* error) = 0;
+};
+
+namespace {
+
+class PlainSource : public DecompressSource {
+ public:
+  explicit PlainSource(std::FILE* file) : file_(file) {}
+  ~PlainSource() override { std::fclose(file_); }
+
+  std::size_t Read(char* out, std::size_t capacity,
+                   std::string* error) override {
+    std::size_t read = std::fread(out, 1, capacity, file_);
+    if (read == 0 && std::ferror(file_)) {
+      *error = "read error";
+    }
+
+    return read;
+  }
+
+ private:
+  std::FILE* file_;
+};
+
+#ifdef JPP_HAVE_ZLIB
+class GzipSource : public DecompressSource {
+ public:
+  explicit GzipSource(gzFile file) : file_(file) {
+    gzbuffer(file_, 1 << 17);
+  }
+  ~GzipSource() override { gzclose(file_); }
+
+  std::size_t Read(char* out, std::size_t capacity,
+                   std::string* error) override {
+    // concatenated members are read as one stream
+    int read = gzread(file_, out,
+                      static_cast<unsigned>(std::min<std::size_t>(
+                          capacity, static_cast<std::size_t>(INT_MAX))));
+    int code = Z_OK;
+    const char* message = gzerror(file_, &code);
+    if (read < 0 || (read == 0 && code != Z_OK)) {
+      *error = std::string("gzip: ") + message;
+      return 0;
+    }
+
+    return static_cast<std::size_t>(read);
+  }
+
+ private:
+  gzFile file_;
+};
+#endif
+
+#ifdef JPP_HAVE_ZSTD
+class ZstdSource : public DecompressSource {
+ public:
+  ZstdSource(std::FILE* file, ZSTD_DStream* stream)
+      : file_(file),
+        stream_(stream),
+        input_(ZSTD_DStreamInSize()),
+        in_{input_.data(), 0, 0},
+        pending_(0) {}
+  ~ZstdSource() override {
+    ZSTD_freeDStream(stream_);
+    std::fclose(file_);
+  }
+
+  std::size_t Read(char* out, std::size_t capacity,
+                   std::string* error) override {
+    ZSTD_outBuffer output{out, capacity, 0};
+
+    while (output.pos < output.size) {
+      if (in_.pos == in_.size) {
+        std::size_t read = std::fread(input_.data(), 1, input_.size(), file_);
+        if (read == 0) {
+          if (std::ferror(file_)) {
+            *error = "read error";
+          } else if (pending_ != 0) {
+            // frames can follow each other, but the last must be complete
+            *error = "zstd: truncated input";
+          }
+          break;
+        }
+        in_ = ZSTD_inBuffer{input_.data(), read, 0};
+      }
+
+      std::size_t result = ZSTD_decompressStream(stream_, &output, &in_);
+      if (ZSTD_isError(result)) {
+        *error = std::string("zstd: ") + ZSTD_getErrorName(result);
+        return 0;
+      }
+      pending_ = result;
+    }
+
+    return output.pos;
+  }
+
+ private:
+  std::FILE* file_;
+  ZSTD_DStream* stream_;
+  std::vector<char> input_;
+  ZSTD_inBuffer in_;
+  // nonzero while a frame is not finished
+  std::size_t pending_;
+};
+#endif
+
+std::unique_ptr<DecompressSource> OpenSource(const char* path,
+                                             Compression compression,
+                                             std::string* error) {
+  std::unique_ptr<DecompressSource> source;
+
+  switch (compression) {
+    case Compression::None: {
+      std::FILE* file = std::fopen(path, "rb");
+      if (file != nullptr) {
+        source.reset(new PlainSource(file));
+      }
+      break;
+    }
+    case Compression::Gzip: {
+#ifdef JPP_HAVE_ZLIB
+      gzFile file = gzopen(path, "rb");
+      if (file != nullptr) {
+        source.reset(new GzipSource(file));
+      }
+#endif
+      break;
+    }
+    case Compression::Zstd: {
+#ifdef JPP_HAVE_ZSTD
+      std::FILE* file = std::fopen(path, "rb");
+      if (file == nullptr) {
+        break;
+      }
+      ZSTD_DStream* stream = ZSTD_createDStream();
+      if (stream == nullptr) {
+        std::fclose(file);
+        break;
+      }
+      ZSTD_initDStream(stream);
+      source.reset(new ZstdSource(file, stream));
+#endif
+      break;
+    }
+  }
+
+  if (source == nullptr) {
+    *error = std::string("cannot open ") + path;
+  }
+
+  return source;
+}
+
+}  // namespace
+
+DecompressReader::DecompressReader(bool whole_lines, std::size_t buffer_size,
+                                   std::size_t buffer_count)
+    : whole_lines_(whole_lines),
+      buffer_size_(std::max<std::size_t>(buffer_size, 1)),
+      ring_(std::max<std::size_t>(buffer_count, 1)),
+      head_(0),
+      tail_(0),
+      done_(true),
+      stop_(false),
+      bytes_read_(0) {}
+
+DecompressReader::~DecompressReader() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  emptied_.notify_all();
+
+  if (producer_.joinable()) {
+    producer_.join();
+  }
+}
+
+Compression DecompressReader::Detect(const char* path) {
+#ifndef _WIN32
+  // a pipe cannot be read twice, the bytes sniffed here would be lost
+  struct stat status {};
+  if (stat(path, &status) != 0 || !S_ISREG(status.st_mode)) {
+    return Compression::None;
+  }
+#endif
+
+  std::FILE* file = std::fopen(path, "rb");
+  if (file == nullptr) {
+    return Compression::None;
+  }
+
+  unsigned char magic[4] = {};
+  std::size_t read = std::fread(magic, 1, sizeof(magic), file);
+  std::fclose(file);
+
+  if (read >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+    return Compression::Gzip;
+  }
+  if (read == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f &&
+      magic[3] == 0xfd) {
+    return Compression::Zstd;
+  }
+
+  return Compression::None;
+}
+
+bool DecompressReader::Supported(Compression compression) {
+  switch (compression) {
+    case Compression::None:
+      return true;
+    case Compression::Gzip:
+#ifdef JPP_HAVE_ZLIB
+      return true;
+#else
+      return false;
+#endif
+    case Compression::Zstd:
+#ifdef JPP_HAVE_ZSTD
+      return true;
+#else
+      return false;
+#endif
+  }
+
+  return false;
+}
+
+bool DecompressReader::Open(const char* path) {
+  if (producer_.joinable()) {
+    error_ = "reader is already open";
+    return false;
+  }
+
+  Compression compression = Detect(path);
+  if (!Supported(compression)) {
+    error_ = std::string(path) + ": " +
+             (compression == Compression::Gzip ? "gzip" : "zstd") +
+             " support was not built in";
+    return false;
+  }
+
+  source_ = OpenSource(path, compression, &error_);
+  if (source_ == nullptr) {
+    return false;
+  }
+
+  done_ = false;
+  producer_ = std::thread(&DecompressReader::Produce, this);
+
+  return true;
+}
+
+void DecompressReader::Chunk::Reserve(std::size_t length) {
+  if (length < capacity_) {
+    return;
+  }
+
+  // grow by half like the parse stack, so a long line is not copied often
+  std::size_t capacity = std::max(length + 1, capacity_ + capacity_ / 2);
+  // new char[] leaves the bytes uninitialized, make_unique would zero them
+  std::unique_ptr<char[]> data(new char[capacity]);
+  if (length_ > 0) {
+    std::memcpy(data.get(), data_.get(), length_);
+  }
+  data_ = std::move(data);
+  capacity_ = capacity;
+}
+
+bool DecompressReader::Next(Chunk* chunk) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  filled_.wait(lock, [this]() { return head_ != tail_ || done_; });
+  if (head_ == tail_) {
+    error_ = producer_error_;
+    return false;
+  }
+
+  // the old content of chunk becomes a free buffer of the ring
+  std::swap(*chunk, ring_[head_ % ring_.size()]);
+  ++head_;
+  lock.unlock();
+  emptied_.notify_one();
+
+  bytes_read_ += chunk->length_;
+
+  return true;
+}
+
+void DecompressReader::Produce() {
+  Chunk buffer;
+  // bytes behind the last '\n' of a chunk, they start the next one
+  std::string carry;
+  std::string error;
+  bool eof = false;
+
+  while (!eof) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      emptied_.wait(lock,
+                    [this]() { return stop_ || tail_ - head_ < ring_.size(); });
+      if (stop_) {
+        return;
+      }
+      std::swap(buffer, ring_[tail_ % ring_.size()]);
+    }
+
+    // a buffer handed back by the consumer keeps its capacity
+    buffer.length_ = 0;
+    if (!carry.empty()) {
+      buffer.Reserve(carry.size());
+      std::memcpy(buffer.data_.get(), carry.data(), carry.size());
+      buffer.length_ = carry.size();
+    }
+    carry.clear();
+
+    for (;;) {
+      std::size_t size = buffer.length_;
+      std::size_t want =
+          std::max(buffer_size_ > size ? buffer_size_ - size : 0, kMinRead);
+      buffer.Reserve(size + want);
+      std::size_t read =
+          source_->Read(buffer.data_.get() + size, want, &error);
+      buffer.length_ = size + read;
+      if (read == 0) {
+        eof = true;
+        break;
+      }
+
+      if (buffer.length_ >= buffer_size_) {
+        if (!whole_lines_) {
+          break;
+        }
+
+        // carry never holds a '\n', only the bytes just read are searched
+        const char* data = buffer.data_.get();
+        std::size_t newline = buffer.length_;
+        while (newline > size && data[newline - 1] != '\n') {
+          --newline;
+        }
+        if (newline > size) {
+          carry.assign(data + newline, buffer.length_ - newline);
+          buffer.length_ = newline;
+          break;
+        }
+        // a line longer than a buffer, keep reading until it ends
+      }
+    }
+    buffer.data_[buffer.length_] = '\0';
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      std::swap(buffer, ring_[tail_ % ring_.size()]);
+      // the bytes read before a failure may end mid record, they are
+      // dropped so the failure is reported instead of a parse error
+      if (ring_[tail_ % ring_.size()].length_ != 0 && error.empty()) {
+        ++tail_;
+      }
+      if (eof) {
+        producer_error_ = error;
+        done_ = true;
+      }
+    }
+    filled_.notify_one();
+  }
+}
+
+}  // namespace jpp
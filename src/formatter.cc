@@ -0,0 +1,146 @@
+/**
+ * @file formatter.cc
+ * @author Mao Zhang (mao.zhang233@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "formatter.h"
+
+namespace jpp {
+
+namespace {
+
+inline bool IsWhitespace(char character) {
+  return character == ' ' || character == '\t' || character == '\n' ||
+         character == '\r';
+}
+
+}  // namespace
+
+void Formatter::Feed(std::string_view data) {
+  if (pretty_) {
+    FeedPretty(data);
+  } else {
+    FeedMinify(data);
+  }
+}
+
+void Formatter::Finish() {
+  if (pretty_) {
+    out_->push_back('\n');
+  }
+}
+
+void Formatter::FeedMinify(std::string_view data) {
+  const char* p = data.data();
+  const char* end = p + data.size();
+
+  // copy whole runs at once instead of byte by byte
+  while (p != end) {
+    const char* run = p;
+
+    if (in_string_) {
+      while (p != end && (escaped_ || (*p != '\"' && *p != '\\'))) {
+        escaped_ = false;
+        ++p;
+      }
+      if (p != end) {
+        if (*p == '\\') {
+          escaped_ = true;
+        } else {
+          in_string_ = false;
+        }
+        ++p;
+      }
+    } else {
+      while (p != end && !IsWhitespace(*p) && *p != '\"') {
+        ++p;
+      }
+      if (p != end && *p == '\"') {
+        in_string_ = true;
+        ++p;
+      }
+    }
+    out_->append(run, static_cast<std::size_t>(p - run));
+
+    if (!in_string_) {
+      while (p != end && IsWhitespace(*p)) {
+        ++p;
+      }
+    }
+  }
+}
+
+void Formatter::FeedPretty(std::string_view data) {
+  for (char character : data) {
+    if (in_string_) {
+      out_->push_back(character);
+      if (escaped_) {
+        escaped_ = false;
+      } else if (character == '\\') {
+        escaped_ = true;
+      } else if (character == '\"') {
+        in_string_ = false;
+      }
+      continue;
+    }
+
+    if (IsWhitespace(character)) {
+      continue;
+    }
+
+    // an empty container stays on one line
+    if (open_pending_) {
+      open_pending_ = false;
+      if (character == '}' || character == ']') {
+        --depth_;
+        out_->push_back(character);
+        continue;
+      }
+      Newline();
+    }
+
+    switch (character) {
+      case '{':
+      case '[':
+        out_->push_back(character);
+        ++depth_;
+        open_pending_ = true;
+        break;
+      case '}':
+      case ']':
+        if (depth_ > 0) {
+          --depth_;
+        }
+        Newline();
+        out_->push_back(character);
+        break;
+      case ',':
+        out_->push_back(character);
+        Newline();
+        break;
+      case ':':
+        out_->push_back(character);
+        out_->push_back(' ');
+        break;
+      case '\"':
+        in_string_ = true;
+        out_->push_back(character);
+        break;
+      default:
+        out_->push_back(character);
+        break;
+    }
+  }
+}
+
+void Formatter::Newline() {
+  out_->push_back('\n');
+  out_->append(depth_ * 2, ' ');
+}
+
+}  // namespace jpp
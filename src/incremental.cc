@@ -0,0 +1,238 @@
+/**
+ * @file incremental.cc
+ * @author Mao Zhang (mao.zhang233@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "incremental.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+
+namespace jpp {
+
+namespace {
+
+inline bool IsWhitespace(char character) {
+  return character == ' ' || character == '\t' || character == '\n' ||
+         character == '\r';
+}
+
+inline const char* SkipWhitespace(const char* p) {
+  while (IsWhitespace(*p)) {
+    ++p;
+  }
+
+  return p;
+}
+
+// p points at the opening quotation mark, returns just behind the closing one
+inline const char* SkipString(const char* p) {
+  for (++p; *p != '\"'; ++p) {
+    if (*p == '\\') {
+      ++p;
+    }
+  }
+
+  return p + 1;
+}
+
+inline bool Encloses(std::size_t begin, std::size_t length, const Edit& edit) {
+  return edit.offset >= begin && edit.offset + edit.removed <= begin + length;
+}
+
+}  // namespace
+
+IncrementalDocument::IncrementalDocument(const Options& options)
+    : options_(options), span_{0, 0, {}}, valid_(false), reparsed_length_(0) {
+  options_.lazy_numbers = false;
+}
+
+Result IncrementalDocument::Parse(const char* json) { return ParseAll(json); }
+
+Result IncrementalDocument::ParseAll(const char* json) {
+  reparsed_length_ = std::strlen(json);
+
+  Result result = JSON::Parse(&root_, json, options_);
+  valid_ = result == Result::OK;
+  if (!valid_) {
+    JSON::SetNull(&root_);
+    span_ = Span{0, 0, {}};
+    return result;
+  }
+
+  BuildSpans(json, &span_);
+
+  return Result::OK;
+}
+
+Result IncrementalDocument::Reparse(const char* json, const Edit& edit) {
+  if (!valid_ || !Encloses(span_.begin, span_.length, edit)) {
+    return ParseAll(json);
+  }
+
+  // walk down to the smallest value enclosing the edit
+  std::vector<Step> path;
+  path.push_back(Step{&span_, &root_, span_.begin, 0});
+
+  for (;;) {
+    const Step& step = path.back();
+    std::vector<Span>& children = step.span->children;
+
+    // children are sorted and apart, only the last one starting at or
+    // before the edit can enclose it
+    std::size_t offset = edit.offset - step.begin;
+    auto next = std::upper_bound(
+        children.begin(), children.end(), offset,
+        [](std::size_t offset, const Span& child) {
+          return offset < child.begin;
+        });
+    if (next == children.begin()) {
+      break;
+    }
+    std::size_t index = static_cast<std::size_t>(next - children.begin()) - 1;
+    if (!Encloses(step.begin + children[index].begin, children[index].length,
+                  edit)) {
+      break;
+    }
+
+    Value* child = JSON::GetType(step.value) == Type::Array
+                       ? JSON::GetArrayElement(step.value, index)
+                       : JSON::GetObjectValue(step.value, index);
+    path.push_back(Step{&children[index], child,
+                        step.begin + children[index].begin, index});
+  }
+
+  // sizes are unsigned, a shrinking edit relies on wrap-around when added
+  std::size_t delta = edit.inserted - edit.removed;
+
+  // re-parse the innermost value, if the new text is no longer exactly one
+  // value (e.g. "1" became "1, 2") try its enclosing container instead
+  for (std::size_t level = path.size() - 1; level > 0; --level) {
+    Step& step = path[level];
+    std::size_t length = step.span->length + delta;
+    if (length == 0) {
+      continue;
+    }
+
+    std::string text(json + step.begin, length);
+    if (IsWhitespace(text.front()) || IsWhitespace(text.back())) {
+      continue;
+    }
+
+    // the value sits inside level containers already
+    Options options = options_;
+    options.max_depth =
+        options_.max_depth > level ? options_.max_depth - level : 0;
+
+    Value value;
+    if (JSON::Parse(&value, text.c_str(), options) != Result::OK) {
+      continue;
+    }
+
+    Span span;
+    BuildSpans(text.c_str(), &span);
+    span.begin = step.span->begin;
+
+    JSON::MoveValue(step.value, &value);
+    *step.span = std::move(span);
+
+    // grow every ancestor and shift the siblings following the path. This
+    // touches every later sibling on the path, which is cheap next to
+    // parsing, but dominates an edit near the front of a huge container.
+    for (std::size_t up = level; up-- > 0;) {
+      Span* parent = path[up].span;
+      for (std::size_t i = path[up + 1].index + 1; i < parent->children.size();
+           ++i) {
+        parent->children[i].begin += delta;
+      }
+      parent->length += delta;
+    }
+
+    reparsed_length_ = length;
+
+    return Result::OK;
+  }
+
+  return ParseAll(json);
+}
+
+void IncrementalDocument::BuildSpans(const char* text, Span* span) {
+  // containers still open, with the position they start at
+  std::vector<std::pair<Span*, const char*>> open;
+  const char* base = text;
+  const char* p = SkipWhitespace(text);
+  Span* current = span;
+
+  for (;;) {
+    // p is at the start of a value
+    const char* start = p;
+    current->begin = static_cast<std::size_t>(start - base);
+    current->children.clear();
+
+    bool complete = true;
+    if (*p == '[' || *p == '{') {
+      p = SkipWhitespace(p + 1);
+      if (*p == ']' || *p == '}') {
+        ++p;
+      } else {
+        open.emplace_back(current, start);
+        if (*start == '{') {
+          p = SkipWhitespace(SkipString(p));
+          p = SkipWhitespace(p + 1);
+        }
+        current->children.emplace_back();
+        current = &current->children.back();
+        base = start;
+        complete = false;
+      }
+    } else if (*p == '\"') {
+      p = SkipString(p);
+    } else {
+      while (*p != ',' && *p != ']' && *p != '}' && *p != '\0' &&
+             !IsWhitespace(*p)) {
+        ++p;
+      }
+    }
+
+    if (!complete) {
+      continue;
+    }
+    current->length = static_cast<std::size_t>(p - start);
+
+    // close every container the value completes
+    for (;;) {
+      if (open.empty()) {
+        return;
+      }
+
+      auto [container, container_start] = open.back();
+      p = SkipWhitespace(p);
+
+      if (*p == ',') {
+        p = SkipWhitespace(p + 1);
+        if (*container_start == '{') {
+          p = SkipWhitespace(SkipString(p));
+          p = SkipWhitespace(p + 1);
+        }
+        container->children.emplace_back();
+        current = &container->children.back();
+        base = container_start;
+        break;
+      }
+
+      // closing bracket
+      ++p;
+      container->length = static_cast<std::size_t>(p - container_start);
+      open.pop_back();
+    }
+  }
+}
+
+}  // namespace jpp
@@ -10,11 +10,18 @@
  */
 #include "json.h"
 
+#include "key_pool.h"
+
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
 #include <cmath>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <limits>
+#include <new>
+#include <utility>
 
 namespace jpp {
 
@@ -32,13 +39,341 @@ namespace jpp {
 
 #define ISDIGIT1TO9(character) ((character) >= '1' && (character) <= '9')
 
+#define PUTS(context, str, length)                                \
+  do {                                                            \
+    std::memcpy(ContextPush(context, (length)), (str), (length)); \
+  } while (0)
+
 #define PUTCHAR(context, character)                                      \
   do {                                                                   \
-    *reinterpret_cast<char*>(ContextPush(context, sizeof(character))) == \
-        (character);                                                     \
+    *reinterpret_cast<char*>(ContextPush(context, sizeof(character))) = \
+        (character);                                                    \
   } while (0)
 
+namespace {
+
+constexpr std::uint64_t kHashOffsetBasis = 0xcbf29ce484222325ULL;
+constexpr std::uint64_t kHashPrime = 0x100000001b3ULL;
+
+// per type seeds keep e.g. false, 0 and "" apart
+constexpr std::uint64_t kHashSeedNull = 0x9ae16a3b2f90404fULL;
+constexpr std::uint64_t kHashSeedFalse = 0xc3a5c85c97cb3127ULL;
+constexpr std::uint64_t kHashSeedTrue = 0xb492b66fbe98f273ULL;
+constexpr std::uint64_t kHashSeedNumber = 0x9ddfea08eb382d69ULL;
+constexpr std::uint64_t kHashSeedString = 0xff51afd7ed558ccdULL;
+constexpr std::uint64_t kHashSeedArray = 0xc6a4a7935bd1e995ULL;
+constexpr std::uint64_t kHashSeedObject = 0x87c37b91114253d5ULL;
+
+// splitmix64 finalizer, spreads every input bit over the whole word
+inline std::uint64_t MixHash(std::uint64_t hash) {
+  hash ^= hash >> 30;
+  hash *= 0xbf58476d1ce4e5b9ULL;
+  hash ^= hash >> 27;
+  hash *= 0x94d049bb133111ebULL;
+  hash ^= hash >> 31;
+
+  return hash;
+}
+
+// FNV-1a over raw bytes
+inline std::uint64_t HashBytes(const char* bytes, std::size_t length) {
+  std::uint64_t hash = kHashOffsetBasis;
+
+  for (std::size_t i = 0; i < length; ++i) {
+    hash ^= static_cast<unsigned char>(bytes[i]);
+    hash *= kHashPrime;
+  }
+
+  return hash;
+}
+
+inline std::uint64_t HashNumber(double number) {
+  // -0.0 == 0.0 so both must hash the same
+  if (number == 0.0) {
+    number = 0.0;
+  }
+
+  std::uint64_t bits = 0;
+  std::memcpy(&bits, &number, sizeof(bits));
+
+  return MixHash(kHashSeedNumber ^ bits);
+}
+
+inline std::uint64_t HashString(const char* str, std::size_t length) {
+  return MixHash(kHashSeedString ^ HashBytes(str, length) ^ length);
+}
+
+// elements are chained so their order matters
+inline std::uint64_t CombineElementHash(std::uint64_t hash,
+                                        std::uint64_t element) {
+  return MixHash(hash + element);
+}
+
+// members are summed so their order does not matter
+inline std::uint64_t CombineMemberHash(std::uint64_t hash, std::uint64_t key,
+                                       std::uint64_t value) {
+  return hash + MixHash(key ^ MixHash(value));
+}
+
+inline std::uint64_t FinishArrayHash(std::uint64_t hash, std::size_t size) {
+  return MixHash(hash ^ size);
+}
+
+inline std::uint64_t FinishObjectHash(std::uint64_t hash, std::size_t size) {
+  return MixHash(kHashSeedObject ^ hash ^ size);
+}
+
+// first byte of a value (or whitespace) decides what to do next
+enum ByteClass : std::uint8_t {
+  kByteInvalid,
+  kByteEnd,
+  kByteWhitespace,
+  kByteNumber,
+  kByteTrue,
+  kByteFalse,
+  kByteNull,
+  kByteString,
+  kByteArray,
+  kByteObject
+};
+
+struct ByteClassTable {
+  std::uint8_t classes[256];
+};
+
+constexpr ByteClassTable MakeByteClassTable() {
+  ByteClassTable table{};
+
+  table.classes[static_cast<unsigned char>('\0')] = kByteEnd;
+  table.classes[static_cast<unsigned char>(' ')] = kByteWhitespace;
+  table.classes[static_cast<unsigned char>('\t')] = kByteWhitespace;
+  table.classes[static_cast<unsigned char>('\n')] = kByteWhitespace;
+  table.classes[static_cast<unsigned char>('\r')] = kByteWhitespace;
+  table.classes[static_cast<unsigned char>('-')] = kByteNumber;
+  for (char character = '0'; character <= '9'; ++character) {
+    table.classes[static_cast<unsigned char>(character)] = kByteNumber;
+  }
+  table.classes[static_cast<unsigned char>('t')] = kByteTrue;
+  table.classes[static_cast<unsigned char>('f')] = kByteFalse;
+  table.classes[static_cast<unsigned char>('n')] = kByteNull;
+  table.classes[static_cast<unsigned char>('\"')] = kByteString;
+  table.classes[static_cast<unsigned char>('[')] = kByteArray;
+  table.classes[static_cast<unsigned char>('{')] = kByteObject;
+
+  return table;
+}
+
+constexpr ByteClassTable kByteClassTable = MakeByteClassTable();
+
+inline std::uint8_t ByteClassOf(char character) {
+  return kByteClassTable.classes[static_cast<unsigned char>(character)];
+}
+
+constexpr std::size_t kNoFrame = static_cast<std::size_t>(-1);
+
+// an open array or object, lives on the context stack followed by the
+// elements (Value) or members (Member) parsed so far
+struct Frame {
+  std::size_t parent;
+  std::size_t size;
+  std::uint64_t hash;
+  std::uint64_t key_hash;
+  Type type;
+};
+
+// everything pushed between string bodies keeps the stack aligned
+static_assert(sizeof(Frame) % alignof(Frame) == 0 &&
+                  sizeof(Frame) % alignof(Member) == 0 &&
+                  sizeof(Frame) % alignof(Value) == 0,
+              "frame breaks stack alignment");
+static_assert(sizeof(Value) % alignof(Frame) == 0 &&
+                  sizeof(Member) % alignof(Frame) == 0,
+              "value breaks stack alignment");
+
+inline Frame* CurrentFrame(Context* context) {
+  assert(context->frame != kNoFrame);
+
+  return reinterpret_cast<Frame*>(context->stack + context->frame);
+}
+
+inline char* FrameBegin(Context* context) {
+  return context->stack + context->frame + sizeof(Frame);
+}
+
+// a container some tree walk is inside of. Walks keep these on a context
+// stack instead of recursing, so deep values cannot overflow the native
+// stack no matter how max_depth is set.
+struct Walk {
+  const Value* source;
+  const Value* other;
+  Value* target;
+  std::size_t index;
+  std::uint64_t hash;
+};
+
+inline Walk* TopWalk(Context* walks) {
+  assert(walks->top >= sizeof(Walk));
+
+  return reinterpret_cast<Walk*>(walks->stack + walks->top - sizeof(Walk));
+}
+
+inline bool IsContainer(const Value* value) {
+  return value->type == Type::Array || value->type == Type::Object;
+}
+
+inline std::size_t ChildCount(const Value* value) {
+  return value->type == Type::Array ? value->array.size : value->object.size;
+}
+
+inline std::uint64_t HashScalar(const Value* value) {
+  switch (value->type) {
+    case Type::False:
+      return kHashSeedFalse;
+    case Type::True:
+      return kHashSeedTrue;
+    case Type::Number:
+      // hashing is no reason to give up on a lazy number, leave it as is
+      return HashNumber(value->number.converted
+                            ? value->number.value
+                            : strtod(value->number.lexeme, nullptr));
+    case Type::String:
+      return HashString(value->string.literal, value->string.length);
+    default:
+      return kHashSeedNull;
+  }
+}
+
+// fold hash of the child just taken from walk into walk
+inline void FoldHash(Walk* walk, std::uint64_t hash) {
+  const Value* container = walk->source;
+  if (container->type == Type::Array) {
+    walk->hash = CombineElementHash(walk->hash, hash);
+  } else {
+    const String& key = container->object.members[walk->index - 1].key;
+    walk->hash = CombineMemberHash(
+        walk->hash, HashString(key.literal, key.length), hash);
+  }
+}
+
+inline std::uint64_t FinishHash(const Walk* walk) {
+  const Value* container = walk->source;
+  return container->type == Type::Array
+             ? FinishArrayHash(walk->hash, container->array.size)
+             : FinishObjectHash(walk->hash, container->object.size);
+}
+
+inline bool SameKey(const String& lhs, const String& rhs) {
+  return lhs.length == rhs.length &&
+         std::memcmp(lhs.literal, rhs.literal, lhs.length) == 0;
+}
+
+// byte wise order of keys, a prefix sorts first
+inline int CompareKey(const String& lhs, const String& rhs) {
+  int compared = std::memcmp(lhs.literal, rhs.literal,
+                             std::min(lhs.length, rhs.length));
+  if (compared != 0) {
+    return compared;
+  }
+
+  return lhs.length < rhs.length ? -1 : lhs.length > rhs.length ? 1 : 0;
+}
+
+// take over storage of from, which dst must not hold any, without touching
+// the heap. from is left as null.
+inline void TakeValue(Value* dst, Value* from) {
+  switch (from->type) {
+    case Type::String:
+      dst->string = from->string;
+      break;
+    case Type::Array:
+      dst->array = from->array;
+      break;
+    case Type::Object:
+      dst->object = from->object;
+      break;
+    case Type::Number:
+      dst->number = from->number;
+      break;
+    case Type::False:
+    case Type::True:
+      dst->boolean = from->boolean;
+      break;
+    default:
+      break;
+  }
+  dst->type = from->type;
+
+  // from no longer owns anything
+  from->type = Type::Null;
+}
+
+}  // namespace
+
+Value::Value() noexcept : type(Type::Null) {}
+
+Value::~Value() { JSON::FreeValue(this); }
+
+Value::Value(Value&& other) noexcept : type(Type::Null) {
+  JSON::MoveValue(this, &other);
+}
+
+Value& Value::operator=(Value&& other) noexcept {
+  JSON::MoveValue(this, &other);
+
+  return *this;
+}
+
+void Value::Swap(Value& other) noexcept { JSON::SwapValue(this, &other); }
+
+Value Value::Clone() const {
+  Value value;
+  JSON::CopyValue(&value, this);
+
+  return value;
+}
+
+void swap(Value& lhs, Value& rhs) noexcept { lhs.Swap(rhs); }
+
+Result Document::Parse(const char* json) { return Parse(json, Options{}); }
+
+Result Document::Parse(const char* json, const Options& options) {
+  return JSON::Parse(&root_, json, options);
+}
+
+Value Document::Release() noexcept { return std::move(root_); }
+
+std::uint64_t Document::Hash() const { return JSON::Hash(&root_); }
+
+Document Document::Clone() const {
+  Document document;
+  JSON::CopyValue(&document.root_, &root_);
+
+  return document;
+}
+
+void Document::Swap(Document& other) noexcept { root_.Swap(other.root_); }
+
+void swap(Document& lhs, Document& rhs) noexcept { lhs.Swap(rhs); }
+
+bool operator==(const Document& lhs, const Document& rhs) {
+  // hashing both sides first would cost as much as comparing them
+  return JSON::Equal(&lhs.Root(), &rhs.Root());
+}
+
+bool operator!=(const Document& lhs, const Document& rhs) {
+  return !(lhs == rhs);
+}
+
 Result JSON::Parse(Value* value, const char* json) {
+  return Parse(value, json, nullptr);
+}
+
+Result JSON::Parse(Value* value, const char* json, std::uint64_t* hash) {
+  return Parse(value, json, Options{}, hash);
+}
+
+Result JSON::Parse(Value* value, const char* json, const Options& options,
+                   std::uint64_t* hash) {
   assert(value != nullptr);
 
   Context context{};
@@ -46,8 +381,16 @@ Result JSON::Parse(Value* value, const char* json) {
   context.stack = nullptr;
   context.top = 0;
   context.size = 0;
+  context.frame = kNoFrame;
+  context.depth = 0;
+  context.max_depth = options.max_depth;
+  context.lazy_numbers = options.lazy_numbers;
+  context.key_pool = options.key_pool;
+  context.hashing = hash != nullptr;
+  context.hash = 0;
 
-  value->type = Type::Null;
+  // release whatever value held before
+  FreeValue(value);
 
   ParseWhitespace(&context);
 
@@ -57,49 +400,324 @@ Result JSON::Parse(Value* value, const char* json) {
     ParseWhitespace(&context);
 
     if (*context.json != '\0') {
-      return Result::RootNotSingular;
+      result = Result::RootNotSingular;
+    } else if (hash != nullptr) {
+      *hash = context.hash;
     }
   }
 
   assert(context.top == 0);
-  delete context.stack;
+  free(context.stack);
 
   return result;
 }
 
 Result JSON::ParseValue(Context* context, Value* value) {
-  switch (*context->json) {
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':
-    case '-':
-      return ParseNumber(context, value);
-    case 't':
-      return ParseTrue(context, value);
-    case 'f':
-      return ParseFalse(context, value);
-    case 'n':
-      return ParseNull(context, value);
-    case '\"':
-      return ParseString(context, value);
-    case '\0':
-      return Result::ExpectValue;
-    default:
-      return Result::InvalidValue;
+  // frames opened by this call sit above base
+  const std::size_t base = context->frame;
+  // the value completed last, before it is attached to its container
+  Value current;
+  Result result = Result::OK;
+
+  for (;;) {
+    // expect a value
+    switch (ByteClassOf(*context->json)) {
+      case kByteNumber:
+        result = ParseNumber(context, &current);
+        break;
+      case kByteTrue:
+        result = ParseTrue(context, &current);
+        break;
+      case kByteFalse:
+        result = ParseFalse(context, &current);
+        break;
+      case kByteNull:
+        result = ParseNull(context, &current);
+        break;
+      case kByteString:
+        result = ParseString(context, &current);
+        break;
+      case kByteArray:
+        result = ContextOpen(context, Type::Array);
+        if (result != Result::OK) {
+          break;
+        }
+        ParseWhitespace(context);
+        if (*context->json != ']') {
+          continue;
+        }
+        ++context->json;
+        ContextCloseArray(context, &current);
+        break;
+      case kByteObject:
+        result = ContextOpen(context, Type::Object);
+        if (result != Result::OK) {
+          break;
+        }
+        ParseWhitespace(context);
+        if (*context->json != '}') {
+          result = ParseMemberKey(context);
+          if (result == Result::OK) {
+            continue;
+          }
+          break;
+        }
+        ++context->json;
+        ContextCloseObject(context, &current);
+        break;
+      case kByteEnd:
+        result = Result::ExpectValue;
+        break;
+      default:
+        result = Result::InvalidValue;
+        break;
+    }
+
+    if (result != Result::OK) {
+      // NumberTooBig still leaves the number in the root value
+      if (result == Result::NumberTooBig && context->frame == base) {
+        MoveValue(value, &current);
+      }
+      ContextUnwind(context, base);
+      return result;
+    }
+
+    // scalars are hashed right after they are read, while still hot in cache
+    // containers got their hash when closed
+    if (context->hashing && current.type != Type::Array &&
+        current.type != Type::Object) {
+      context->hash = Hash(&current);
+    }
+
+    // attach the completed value, closing every container it completes
+    for (;;) {
+      if (context->frame == base) {
+        MoveValue(value, &current);
+        return Result::OK;
+      }
+
+      Frame* frame = CurrentFrame(context);
+
+      if (frame->type == Type::Array) {
+        new (ContextPush(context, sizeof(Value))) Value(std::move(current));
+        frame = CurrentFrame(context);
+        ++frame->size;
+        if (context->hashing) {
+          frame->hash = CombineElementHash(frame->hash, context->hash);
+        }
+
+        ParseWhitespace(context);
+        if (*context->json == ',') {
+          ++context->json;
+          ParseWhitespace(context);
+          break;
+        }
+        if (*context->json == ']') {
+          ++context->json;
+          ContextCloseArray(context, &current);
+          continue;
+        }
+        result = Result::MissingCommaOrSquareBracket;
+      } else {
+        Member* member =
+            reinterpret_cast<Member*>(context->stack + context->top) - 1;
+        MoveValue(&member->value, &current);
+        if (context->hashing) {
+          frame->hash =
+              CombineMemberHash(frame->hash, frame->key_hash, context->hash);
+        }
+
+        ParseWhitespace(context);
+        if (*context->json == ',') {
+          ++context->json;
+          ParseWhitespace(context);
+          result = ParseMemberKey(context);
+          if (result == Result::OK) {
+            break;
+          }
+        } else if (*context->json == '}') {
+          ++context->json;
+          ContextCloseObject(context, &current);
+          continue;
+        } else {
+          result = Result::MissingCommaOrCurlyBracket;
+        }
+      }
+
+      ContextUnwind(context, base);
+      return result;
+    }
+  }
+}
+
+Result JSON::ParseMemberKey(Context* context) {
+  if (*context->json != '\"') {
+    return Result::MissingKey;
+  }
+  ++context->json;
+
+  char* str = nullptr;
+  std::size_t length = 0;
+  Result result = ParseStringRaw(context, &str, &length);
+  if (result != Result::OK) {
+    return result;
+  }
+
+  std::uint64_t key_hash = 0;
+  if (context->hashing) {
+    key_hash = HashString(str, length);
+  }
+
+  // share key storage through the pool when possible
+  char* key = nullptr;
+  bool interned = false;
+  if (context->key_pool != nullptr) {
+    key = const_cast<char*>(context->key_pool->Intern(str, length));
+    interned = key != nullptr;
+  }
+
+  // copy key out before the stack can move, then push it as a member
+  // with a null value, so unwinding frees it on any later error
+  if (!interned) {
+    key = reinterpret_cast<char*>(malloc(length + 1));
+    if (length > 0) {
+      std::memcpy(key, str, length);
+    }
+    key[length] = '\0';
+  }
+
+  Member* member = new (ContextPush(context, sizeof(Member))) Member();
+  member->key.literal = key;
+  member->key.length = length;
+  member->key.interned = interned;
+
+  Frame* frame = CurrentFrame(context);
+  ++frame->size;
+  frame->key_hash = key_hash;
+
+  ParseWhitespace(context);
+  if (*context->json != ':') {
+    return Result::MissingColon;
+  }
+  ++context->json;
+  ParseWhitespace(context);
+
+  return Result::OK;
+}
+
+Result JSON::ContextOpen(Context* context, Type type) {
+  if (context->depth >= context->max_depth) {
+    return Result::NestingTooDeep;
+  }
+
+  // skip '[' or '{'
+  ++context->json;
+
+  std::size_t offset = context->top;
+  Frame* frame = reinterpret_cast<Frame*>(ContextPush(context, sizeof(Frame)));
+  frame->parent = context->frame;
+  frame->size = 0;
+  frame->hash = type == Type::Array ? kHashSeedArray : 0;
+  frame->key_hash = 0;
+  frame->type = type;
+
+  context->frame = offset;
+  ++context->depth;
+
+  return Result::OK;
+}
+
+void JSON::ContextCloseArray(Context* context, Value* value) {
+  Frame* frame = CurrentFrame(context);
+  assert(frame->type == Type::Array);
+
+  std::size_t size = frame->size;
+  Value* elements = nullptr;
+
+  if (size > 0) {
+    // relocate elements from stack into their own storage
+    Value* stacked = reinterpret_cast<Value*>(FrameBegin(context));
+    elements = reinterpret_cast<Value*>(malloc(size * sizeof(Value)));
+    for (std::size_t i = 0; i < size; ++i) {
+      new (elements + i) Value(std::move(stacked[i]));
+      stacked[i].~Value();
+    }
+  }
+
+  if (context->hashing) {
+    context->hash = FinishArrayHash(frame->hash, size);
+  }
+
+  context->top = context->frame;
+  context->frame = frame->parent;
+  --context->depth;
+
+  FreeValue(value);
+  value->array.elements = elements;
+  value->array.size = size;
+  value->type = Type::Array;
+}
+
+void JSON::ContextCloseObject(Context* context, Value* value) {
+  Frame* frame = CurrentFrame(context);
+  assert(frame->type == Type::Object);
+
+  std::size_t size = frame->size;
+  Member* members = nullptr;
+
+  if (size > 0) {
+    // relocate members from stack into their own storage
+    Member* stacked = reinterpret_cast<Member*>(FrameBegin(context));
+    members = reinterpret_cast<Member*>(malloc(size * sizeof(Member)));
+    for (std::size_t i = 0; i < size; ++i) {
+      new (members + i) Member(std::move(stacked[i]));
+      stacked[i].~Member();
+    }
+  }
+
+  if (context->hashing) {
+    context->hash = FinishObjectHash(frame->hash, size);
+  }
+
+  context->top = context->frame;
+  context->frame = frame->parent;
+  --context->depth;
+
+  FreeValue(value);
+  value->object.members = members;
+  value->object.size = size;
+  value->type = Type::Object;
+}
+
+void JSON::ContextUnwind(Context* context, std::size_t frame_offset) {
+  while (context->frame != frame_offset) {
+    Frame* frame = CurrentFrame(context);
+
+    if (frame->type == Type::Array) {
+      Value* stacked = reinterpret_cast<Value*>(FrameBegin(context));
+      for (std::size_t i = 0; i < frame->size; ++i) {
+        stacked[i].~Value();
+      }
+    } else {
+      Member* stacked = reinterpret_cast<Member*>(FrameBegin(context));
+      for (std::size_t i = 0; i < frame->size; ++i) {
+        if (!stacked[i].key.interned) {
+          free(stacked[i].key.literal);
+        }
+        stacked[i].~Member();
+      }
+    }
+
+    context->top = context->frame;
+    context->frame = frame->parent;
+    --context->depth;
   }
 }
 
 void JSON::ParseWhitespace(Context* context) {
   const char* p = context->json;
 
-  while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') {
+  while (ByteClassOf(*p) == kByteWhitespace) {
     ++p;
   }
 
@@ -129,6 +747,7 @@ Result JSON::ParseFalse(Context* context, Value* value) {
   }
 
   context->json += 4;
+  value->boolean = false;
   value->type = Type::False;
 
   return Result::OK;
@@ -143,6 +762,7 @@ Result JSON::ParseTrue(Context* context, Value* value) {
   }
 
   context->json += 3;
+  value->boolean = true;
   value->type = Type::True;
 
   return Result::OK;
@@ -197,18 +817,36 @@ Result JSON::ParseNumber(Context* context, Value* value) {
     } while (ISDIGIT(*p));
   }
 
+  // keep source text only, converted on first read
+  if (context->lazy_numbers &&
+      static_cast<std::size_t>(p - context->json) <=
+          std::numeric_limits<std::uint32_t>::max()) {
+    value->number.value = 0.0;
+    value->number.lexeme = context->json;
+    value->number.length = static_cast<std::uint32_t>(p - context->json);
+    value->number.converted = false;
+    value->type = Type::Number;
+    context->json = p;
+
+    return Result::OK;
+  }
+
   // parse string to number
   char* end = nullptr;
   errno = 0;
-  value->number = strtod(context->json, &end);
+  double number = strtod(context->json, &end);
   if (context->json == end) {
     return Result::InvalidValue;
   }
 
   context->json = end;
+  value->number.value = number;
+  value->number.lexeme = nullptr;
+  value->number.length = 0;
+  value->number.converted = true;
   value->type = Type::Number;
 
-  if (errno == ERANGE || value->number == HUGE_VAL) {
+  if (errno == ERANGE || number == HUGE_VAL) {
     return Result::NumberTooBig;
   }
 
@@ -218,8 +856,20 @@ Result JSON::ParseNumber(Context* context, Value* value) {
 Result JSON::ParseString(Context* context, Value* value) {
   EXPECT(context, '\"');
 
-  std::size_t top = context->top;
+  char* str = nullptr;
   std::size_t length = 0;
+  Result result = ParseStringRaw(context, &str, &length);
+
+  if (result == Result::OK) {
+    SetString(value, str, length);
+  }
+
+  return result;
+}
+
+Result JSON::ParseStringRaw(Context* context, char** str,
+                            std::size_t* length) {
+  std::size_t top = context->top;
   const char* p = context->json;
 
   for (;;) {
@@ -228,9 +878,8 @@ Result JSON::ParseString(Context* context, Value* value) {
 
     switch (character) {
       case '\"':
-        length = context->top - top;
-        SetString(value, reinterpret_cast<char*>(ContextPop(context, length)),
-                  length);
+        *length = context->top - top;
+        *str = reinterpret_cast<char*>(ContextPop(context, *length));
         context->json = p;
         return Result::OK;
       case '\0':
@@ -266,6 +915,7 @@ Result JSON::ParseString(Context* context, Value* value) {
             context->top = top;
             return Result::InvalidStringEscape;
         }
+        break;
       default:
         if (static_cast<unsigned char>(character) < 0x20) {
           context->top = top;
@@ -317,13 +967,483 @@ void JSON::InitValue(Value* value) {
 void JSON::FreeValue(Value* value) {
   assert(value != nullptr);
 
-  // clear string in value
-  if (value->type == Type::String) {
-    delete value->string.literal;
+  Context walks{};
+  Value* current = value;
+  while (current != nullptr) {
+    switch (current->type) {
+      // clear string in value
+      case Type::String:
+        free(current->string.literal);
+        current->type = Type::Null;
+        break;
+      // children are cleared first, the container on the way back
+      case Type::Array:
+      case Type::Object:
+        new (ContextPush(&walks, sizeof(Walk)))
+            Walk{nullptr, nullptr, current, 0, 0};
+        break;
+      default:
+        current->type = Type::Null;
+        break;
+    }
+
+    current = nullptr;
+    while (current == nullptr && walks.top > 0) {
+      Walk* walk = TopWalk(&walks);
+      Value* container = walk->target;
+      if (walk->index < ChildCount(container)) {
+        if (container->type == Type::Array) {
+          current = container->array.elements + walk->index;
+        } else {
+          Member* member = container->object.members + walk->index;
+          if (!member->key.interned) {
+            free(member->key.literal);
+          }
+          current = &member->value;
+        }
+        ++walk->index;
+        continue;
+      }
+
+      // children hold nothing anymore, no destructor has to run on them
+      if (container->type == Type::Array) {
+        free(container->array.elements);
+      } else {
+        free(container->object.members);
+      }
+      container->type = Type::Null;
+      ContextPop(&walks, sizeof(Walk));
+    }
   }
 
-  // clear value type
-  value->type = Type::Null;
+  free(walks.stack);
+}
+
+void JSON::CopyValue(Value* dst, const Value* src) {
+  assert(dst != nullptr && src != nullptr && dst != src);
+
+  // built aside first, src may live inside dst
+  Value copy;
+  Context walks{};
+  const Value* from = src;
+  Value* to = &copy;
+  while (from != nullptr) {
+    switch (from->type) {
+      case Type::String:
+        SetString(to, from->string.literal, from->string.length);
+        break;
+      case Type::Array: {
+        std::size_t size = from->array.size;
+        Value* elements = nullptr;
+        if (size > 0) {
+          elements = reinterpret_cast<Value*>(malloc(size * sizeof(Value)));
+          for (std::size_t i = 0; i < size; ++i) {
+            new (elements + i) Value();
+          }
+        }
+        to->array.elements = elements;
+        to->array.size = size;
+        to->type = Type::Array;
+        new (ContextPush(&walks, sizeof(Walk))) Walk{from, nullptr, to, 0, 0};
+        break;
+      }
+      case Type::Object: {
+        std::size_t size = from->object.size;
+        Member* members = nullptr;
+        if (size > 0) {
+          members = reinterpret_cast<Member*>(malloc(size * sizeof(Member)));
+          for (std::size_t i = 0; i < size; ++i) {
+            const String& key = from->object.members[i].key;
+            Member* member = new (members + i) Member();
+            member->key = key;
+            // interned keys are shared, not copied
+            if (!key.interned) {
+              member->key.literal =
+                  reinterpret_cast<char*>(malloc(key.length + 1));
+              std::memcpy(member->key.literal, key.literal, key.length + 1);
+            }
+          }
+        }
+        to->object.members = members;
+        to->object.size = size;
+        to->type = Type::Object;
+        new (ContextPush(&walks, sizeof(Walk))) Walk{from, nullptr, to, 0, 0};
+        break;
+      }
+      case Type::Number:
+        // a lazy number keeps pointing into the same source text
+        to->number = from->number;
+        to->type = Type::Number;
+        break;
+      case Type::False:
+      case Type::True:
+        SetBoolean(to, from->type == Type::True);
+        break;
+      default:
+        break;
+    }
+
+    from = nullptr;
+    while (from == nullptr && walks.top > 0) {
+      Walk* walk = TopWalk(&walks);
+      std::size_t i = walk->index;
+      if (i == ChildCount(walk->source)) {
+        ContextPop(&walks, sizeof(Walk));
+      } else if (walk->source->type == Type::Array) {
+        from = walk->source->array.elements + i;
+        to = walk->target->array.elements + i;
+      } else {
+        from = &walk->source->object.members[i].value;
+        to = &walk->target->object.members[i].value;
+      }
+      ++walk->index;
+    }
+  }
+
+  free(walks.stack);
+  MoveValue(dst, &copy);
+}
+
+void JSON::MoveValue(Value* dst, Value* src) noexcept {
+  assert(dst != nullptr && src != nullptr);
+
+  if (dst == src) {
+    return;
+  }
+
+  // taken aside first, src may live inside dst and go away with it
+  Value taken;
+  TakeValue(&taken, src);
+  FreeValue(dst);
+  TakeValue(dst, &taken);
+}
+
+void JSON::SwapValue(Value* lhs, Value* rhs) noexcept {
+  assert(lhs != nullptr && rhs != nullptr);
+
+  if (lhs == rhs) {
+    return;
+  }
+
+  Value temp;
+  MoveValue(&temp, lhs);
+  MoveValue(lhs, rhs);
+  MoveValue(rhs, &temp);
+}
+
+char* JSON::Stringify(const Value* value, std::size_t* length) {
+  assert(value != nullptr);
+
+  Context context{};
+  context.stack = nullptr;
+  context.top = 0;
+  context.size = 0;
+
+  StringifyValue(&context, value);
+  PUTCHAR(&context, '\0');
+
+  if (length != nullptr) {
+    *length = context.top - 1;
+  }
+
+  return context.stack;
+}
+
+void JSON::StringifyValue(Context* context, const Value* value) {
+  // context holds the output, open containers are kept apart
+  Context walks{};
+  const Value* current = value;
+  while (current != nullptr) {
+    switch (current->type) {
+      case Type::Null:
+        PUTS(context, "null", 4);
+        break;
+      case Type::False:
+        PUTS(context, "false", 5);
+        break;
+      case Type::True:
+        PUTS(context, "true", 4);
+        break;
+      case Type::Number:
+        if (current->number.lexeme != nullptr) {
+          // passthrough, keeps e.g. big decimals exact
+          PUTS(context, current->number.lexeme, current->number.length);
+        } else if (!std::isfinite(current->number.value)) {
+          // JSON has no inf or nan, write what JSON.stringify writes
+          PUTS(context, "null", 4);
+        } else {
+          // 17 significant digits round-trip any double
+          char* buffer = reinterpret_cast<char*>(ContextPush(context, 32));
+          int written = snprintf(buffer, 32, "%.17g", current->number.value);
+          context->top -= 32 - static_cast<std::size_t>(written);
+        }
+        break;
+      case Type::String:
+        StringifyString(context, current->string.literal,
+                        current->string.length);
+        break;
+      case Type::Array:
+        PUTCHAR(context, '[');
+        new (ContextPush(&walks, sizeof(Walk)))
+            Walk{current, nullptr, nullptr, 0, 0};
+        break;
+      case Type::Object:
+        PUTCHAR(context, '{');
+        new (ContextPush(&walks, sizeof(Walk)))
+            Walk{current, nullptr, nullptr, 0, 0};
+        break;
+    }
+
+    current = nullptr;
+    while (current == nullptr && walks.top > 0) {
+      Walk* walk = TopWalk(&walks);
+      const Value* container = walk->source;
+      if (walk->index == ChildCount(container)) {
+        PUTCHAR(context, container->type == Type::Array ? ']' : '}');
+        ContextPop(&walks, sizeof(Walk));
+        continue;
+      }
+
+      if (walk->index > 0) {
+        PUTCHAR(context, ',');
+      }
+      if (container->type == Type::Array) {
+        current = container->array.elements + walk->index;
+      } else {
+        const Member& member = container->object.members[walk->index];
+        StringifyString(context, member.key.literal, member.key.length);
+        PUTCHAR(context, ':');
+        current = &member.value;
+      }
+      ++walk->index;
+    }
+  }
+
+  free(walks.stack);
+}
+
+void JSON::StringifyString(Context* context, const char* str,
+                           std::size_t length) {
+  static const char kHexDigits[] = "0123456789ABCDEF";
+
+  PUTCHAR(context, '\"');
+
+  for (std::size_t i = 0; i < length; ++i) {
+    unsigned char character = static_cast<unsigned char>(str[i]);
+
+    switch (character) {
+      case '\"':
+        PUTS(context, "\\\"", 2);
+        break;
+      case '\\':
+        PUTS(context, "\\\\", 2);
+        break;
+      case '\b':
+        PUTS(context, "\\b", 2);
+        break;
+      case '\f':
+        PUTS(context, "\\f", 2);
+        break;
+      case '\n':
+        PUTS(context, "\\n", 2);
+        break;
+      case '\r':
+        PUTS(context, "\\r", 2);
+        break;
+      case '\t':
+        PUTS(context, "\\t", 2);
+        break;
+      default:
+        if (character < 0x20) {
+          char* buffer = reinterpret_cast<char*>(ContextPush(context, 6));
+          std::memcpy(buffer, "\\u00", 4);
+          buffer[4] = kHexDigits[character >> 4];
+          buffer[5] = kHexDigits[character & 15];
+        } else {
+          PUTCHAR(context, static_cast<char>(character));
+        }
+    }
+  }
+
+  PUTCHAR(context, '\"');
+}
+
+std::uint64_t JSON::Hash(const Value* value) {
+  assert(value != nullptr);
+
+  Context walks{};
+  const Value* current = value;
+  std::uint64_t hash = 0;
+  while (current != nullptr) {
+    if (IsContainer(current)) {
+      std::uint64_t seed =
+          current->type == Type::Array ? kHashSeedArray : std::uint64_t{0};
+      new (ContextPush(&walks, sizeof(Walk)))
+          Walk{current, nullptr, nullptr, 0, seed};
+    } else {
+      hash = HashScalar(current);
+      if (walks.top > 0) {
+        FoldHash(TopWalk(&walks), hash);
+      }
+    }
+
+    current = nullptr;
+    while (current == nullptr && walks.top > 0) {
+      Walk* walk = TopWalk(&walks);
+      const Value* container = walk->source;
+      if (walk->index < ChildCount(container)) {
+        current = container->type == Type::Array
+                      ? container->array.elements + walk->index
+                      : &container->object.members[walk->index].value;
+        ++walk->index;
+        continue;
+      }
+
+      hash = FinishHash(walk);
+      ContextPop(&walks, sizeof(Walk));
+      if (walks.top > 0) {
+        FoldHash(TopWalk(&walks), hash);
+      }
+    }
+  }
+
+  free(walks.stack);
+
+  return hash;
+}
+
+bool JSON::Equal(const Value* lhs, const Value* rhs) {
+  assert(lhs != nullptr && rhs != nullptr);
+
+  Context walks{};
+  // for every open object, the rhs member paired with each lhs member
+  Context pairs{};
+  bool equal = true;
+  while (equal && lhs != nullptr) {
+    if (lhs != rhs) {
+      if (lhs->type != rhs->type) {
+        equal = false;
+      } else if (lhs->type == Type::Number) {
+        equal = GetNumber(lhs) == GetNumber(rhs);
+      } else if (lhs->type == Type::String) {
+        equal = lhs->string.length == rhs->string.length &&
+                std::memcmp(lhs->string.literal, rhs->string.literal,
+                            lhs->string.length) == 0;
+      } else if (IsContainer(lhs)) {
+        equal = ChildCount(lhs) == ChildCount(rhs);
+        if (equal && lhs->type == Type::Object && lhs->object.size > 0) {
+          equal = PairMembers(&pairs, lhs, rhs);
+        }
+        if (equal) {
+          new (ContextPush(&walks, sizeof(Walk)))
+              Walk{lhs, rhs, nullptr, 0, 0};
+        }
+      }
+    }
+
+    lhs = nullptr;
+    while (equal && lhs == nullptr && walks.top > 0) {
+      Walk* walk = TopWalk(&walks);
+      const Value* left = walk->source;
+      const Value* right = walk->other;
+      std::size_t i = walk->index;
+      std::size_t size = ChildCount(left);
+      if (i == size) {
+        if (left->type == Type::Object && size > 0) {
+          ContextPop(&pairs, size * sizeof(std::size_t));
+        }
+        ContextPop(&walks, sizeof(Walk));
+        continue;
+      }
+      ++walk->index;
+
+      if (left->type == Type::Array) {
+        lhs = left->array.elements + i;
+        rhs = right->array.elements + i;
+      } else {
+        const std::size_t* pair = reinterpret_cast<const std::size_t*>(
+            pairs.stack + pairs.top - size * sizeof(std::size_t));
+        lhs = &left->object.members[i].value;
+        rhs = &right->object.members[pair[i]].value;
+      }
+    }
+  }
+
+  free(walks.stack);
+  free(pairs.stack);
+
+  return equal;
+}
+
+bool JSON::Equal(const Value* lhs, std::uint64_t lhs_hash, const Value* rhs,
+                 std::uint64_t rhs_hash) {
+  // equal values always hash the same
+  return lhs_hash == rhs_hash && Equal(lhs, rhs);
+}
+
+bool JSON::PairMembers(Context* pairs, const Value* lhs, const Value* rhs) {
+  std::size_t size = lhs->object.size;
+  std::size_t offset = pairs->top;
+  ContextPush(pairs, size * sizeof(std::size_t));
+  std::size_t* pair = reinterpret_cast<std::size_t*>(pairs->stack + offset);
+
+  const Member* left = lhs->object.members;
+  const Member* right = rhs->object.members;
+
+  // members in the same order pair up without any lookup
+  std::size_t i = 0;
+  while (i < size && SameKey(left[i].key, right[i].key)) {
+    pair[i] = i;
+    ++i;
+  }
+  if (i == size) {
+    return true;
+  }
+
+  // otherwise through rhs indices sorted by key, then by position. Only
+  // needed while pairing, pushed behind the pairs.
+  ContextPush(pairs, 2 * size * sizeof(std::size_t));
+  pair = reinterpret_cast<std::size_t*>(pairs->stack + offset);
+  std::size_t* order = pair + size;
+  // for the first entry of every key in order, the next unused one
+  std::size_t* next = order + size;
+  for (std::size_t j = 0; j < size; ++j) {
+    order[j] = j;
+    next[j] = j;
+  }
+  std::sort(order, order + size, [right](std::size_t a, std::size_t b) {
+    int compared = CompareKey(right[a].key, right[b].key);
+    return compared < 0 || (compared == 0 && a < b);
+  });
+
+  // each lhs member takes the first unused rhs member with its key, so
+  // duplicate keys pair up in order of appearance and every rhs member is
+  // matched once
+  bool paired = true;
+  for (i = 0; i < size; ++i) {
+    const String& key = left[i].key;
+    std::size_t first = static_cast<std::size_t>(
+        std::lower_bound(order, order + size, key,
+                         [right](std::size_t entry, const String& key) {
+                           return CompareKey(right[entry].key, key) < 0;
+                         }) -
+        order);
+    std::size_t unused = first < size ? next[first] : size;
+    if (unused == size || !SameKey(right[order[unused]].key, key)) {
+      paired = false;
+      break;
+    }
+
+    pair[i] = order[unused];
+    next[first] = unused + 1;
+  }
+
+  ContextPop(pairs, 2 * size * sizeof(std::size_t));
+  if (!paired) {
+    ContextPop(pairs, size * sizeof(std::size_t));
+  }
+
+  return paired;
 }
 
 Type JSON::GetType(const Value* value) { return value->type; }
@@ -340,6 +1460,8 @@ bool JSON::GetBoolean(const Value* value) {
 void JSON::SetBoolean(Value* value, bool boolean) {
   assert(value != nullptr);
 
+  // clear value first
+  SetNull(value);
   value->boolean = boolean;
   value->type = boolean ? Type::True : Type::False;
 }
@@ -347,13 +1469,79 @@ void JSON::SetBoolean(Value* value, bool boolean) {
 double JSON::GetNumber(const Value* value) {
   assert(value != nullptr && value->type == Type::Number);
 
-  return value->number;
+  if (!value->number.converted) {
+    // lexeme was validated while parsing, strtod stops right behind it
+    value->number.value = strtod(value->number.lexeme, nullptr);
+    value->number.converted = true;
+  }
+
+  return value->number.value;
+}
+
+std::int64_t JSON::GetInt64(const Value* value) {
+  assert(value != nullptr && value->type == Type::Number);
+
+  // below 2^53 the cached double holds an integer lexeme exactly, so only
+  // larger ones have to be read from the lexeme again
+  if (value->number.converted &&
+      std::fabs(value->number.value) < 9007199254740992.0) {
+    return static_cast<std::int64_t>(value->number.value);
+  }
+
+  const char* lexeme = value->number.lexeme;
+  if (lexeme != nullptr) {
+    bool integer = true;
+    for (std::uint32_t i = 0; i < value->number.length; ++i) {
+      if (!ISDIGIT(lexeme[i]) && lexeme[i] != '-') {
+        integer = false;
+        break;
+      }
+    }
+    // exact even beyond 2^53, saturates on overflow
+    if (integer) {
+      errno = 0;
+      std::int64_t number = strtoll(lexeme, nullptr, 10);
+      if (errno != ERANGE && !value->number.converted) {
+        // rounds like strtod would, except that strtoll drops the sign of
+        // "-0"
+        value->number.value = number == 0 && lexeme[0] == '-'
+                                  ? -0.0
+                                  : static_cast<double>(number);
+        value->number.converted = true;
+      }
+      return number;
+    }
+  }
+
+  double number = GetNumber(value);
+  if (number >= 9223372036854775807.0) {
+    return std::numeric_limits<std::int64_t>::max();
+  }
+  if (number <= -9223372036854775808.0) {
+    return std::numeric_limits<std::int64_t>::min();
+  }
+
+  return static_cast<std::int64_t>(number);
+}
+
+const char* JSON::GetNumberLexeme(const Value* value, std::size_t* length) {
+  assert(value != nullptr && value->type == Type::Number);
+  assert(length != nullptr);
+
+  *length = value->number.length;
+
+  return value->number.lexeme;
 }
 
 void JSON::SetNumber(Value* value, double number) {
   assert(value != nullptr);
 
-  value->number = number;
+  // clear value first
+  SetNull(value);
+  value->number.value = number;
+  value->number.lexeme = nullptr;
+  value->number.length = 0;
+  value->number.converted = true;
   value->type = Type::Number;
 }
 
@@ -382,8 +1570,106 @@ void JSON::SetString(Value* value, const char* str, std::size_t length) {
   value->string.literal[length] = '\0';
   // set string length
   value->string.length = length;
+  value->string.interned = false;
   // set value type as String
   value->type = Type::String;
 }
 
+std::size_t JSON::GetArraySize(const Value* value) {
+  assert(value != nullptr && value->type == Type::Array);
+
+  return value->array.size;
+}
+
+const Value* JSON::GetArrayElement(const Value* value, std::size_t index) {
+  assert(value != nullptr && value->type == Type::Array);
+  assert(index < value->array.size);
+
+  return value->array.elements + index;
+}
+
+Value* JSON::GetArrayElement(Value* value, std::size_t index) {
+  assert(value != nullptr && value->type == Type::Array);
+  assert(index < value->array.size);
+
+  return value->array.elements + index;
+}
+
+std::size_t JSON::GetObjectSize(const Value* value) {
+  assert(value != nullptr && value->type == Type::Object);
+
+  return value->object.size;
+}
+
+const char* JSON::GetObjectKey(const Value* value, std::size_t index) {
+  assert(value != nullptr && value->type == Type::Object);
+  assert(index < value->object.size);
+
+  return value->object.members[index].key.literal;
+}
+
+std::size_t JSON::GetObjectKeyLength(const Value* value, std::size_t index) {
+  assert(value != nullptr && value->type == Type::Object);
+  assert(index < value->object.size);
+
+  return value->object.members[index].key.length;
+}
+
+const Value* JSON::GetObjectValue(const Value* value, std::size_t index) {
+  assert(value != nullptr && value->type == Type::Object);
+  assert(index < value->object.size);
+
+  return &value->object.members[index].value;
+}
+
+Value* JSON::GetObjectValue(Value* value, std::size_t index) {
+  assert(value != nullptr && value->type == Type::Object);
+  assert(index < value->object.size);
+
+  return &value->object.members[index].value;
+}
+
+std::size_t JSON::FindObjectIndex(const Value* value, const char* key,
+                                  std::size_t length) {
+  assert(value != nullptr && value->type == Type::Object);
+  assert(key != nullptr || length == 0);
+
+  for (std::size_t i = 0; i < value->object.size; ++i) {
+    const String& member_key = value->object.members[i].key;
+    if (member_key.length == length &&
+        std::memcmp(member_key.literal, key, length) == 0) {
+      return i;
+    }
+  }
+
+  return kKeyNotExist;
+}
+
+std::size_t JSON::FindInternedObjectIndex(const Value* value, const char* key,
+                                          std::size_t length) {
+  assert(value != nullptr && value->type == Type::Object);
+  assert(key != nullptr);
+
+  for (std::size_t i = 0; i < value->object.size; ++i) {
+    const String& member_key = value->object.members[i].key;
+    if (member_key.interned) {
+      if (member_key.literal == key) {
+        return i;
+      }
+    } else if (member_key.length == length &&
+               std::memcmp(member_key.literal, key, length) == 0) {
+      return i;
+    }
+  }
+
+  return kKeyNotExist;
+}
+
+const Value* JSON::FindObjectValue(const Value* value, const char* key,
+                                   std::size_t length) {
+  std::size_t index = FindObjectIndex(value, key, length);
+
+  return index == kKeyNotExist ? nullptr : &value->object.members[index].value;
+}
+
 }  // namespace jpp
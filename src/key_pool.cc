@@ -0,0 +1,100 @@
+/**
+ * @file key_pool.cc
+ * @author Mao Zhang (mao.zhang233@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "key_pool.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+
+namespace jpp {
+
+KeyPool::KeyPool(std::size_t max_keys, std::size_t max_key_length)
+    : size_(0), max_keys_(max_keys), max_key_length_(max_key_length) {}
+
+KeyPool::~KeyPool() {
+  for (Shard& shard : shards_) {
+    for (std::string_view key : shard.keys) {
+      free(const_cast<char*>(key.data()));
+    }
+  }
+}
+
+const char* KeyPool::Intern(const char* key, std::size_t length) {
+  if (length > max_key_length_) {
+    return nullptr;
+  }
+
+  std::string_view view(key, length);
+  std::size_t hash = std::hash<std::string_view>{}(view);
+  Shard& shard = ShardOf(hash);
+
+  // hot path: key is already there, only a shared lock is taken
+  {
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto found = shard.keys.find(view);
+    if (found != shard.keys.end()) {
+      return found->data();
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+  // another writer may have added it meanwhile
+  auto found = shard.keys.find(view);
+  if (found != shard.keys.end()) {
+    return found->data();
+  }
+
+  // reserve a slot, give it back if the pool turns out to be full
+  if (size_.fetch_add(1, std::memory_order_relaxed) >= max_keys_) {
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  char* copy = reinterpret_cast<char*>(malloc(length + 1));
+  if (length > 0) {
+    std::memcpy(copy, key, length);
+  }
+  copy[length] = '\0';
+  shard.keys.emplace(copy, length);
+
+  return copy;
+}
+
+const char* KeyPool::Find(const char* key, std::size_t length) const {
+  if (length > max_key_length_) {
+    return nullptr;
+  }
+
+  std::string_view view(key, length);
+  const Shard& shard = ShardOf(std::hash<std::string_view>{}(view));
+
+  std::shared_lock<std::shared_mutex> lock(shard.mutex);
+  auto found = shard.keys.find(view);
+
+  return found == shard.keys.end() ? nullptr : found->data();
+}
+
+std::size_t KeyPool::Size() const noexcept {
+  return size_.load(std::memory_order_relaxed);
+}
+
+KeyPool::Shard& KeyPool::ShardOf(std::size_t hash) noexcept {
+  // low bits pick the bucket inside the set, use high bits for the shard
+  return shards_[(hash >> kShardShift) % kShardCount];
+}
+
+const KeyPool::Shard& KeyPool::ShardOf(std::size_t hash) const noexcept {
+  return shards_[(hash >> kShardShift) % kShardCount];
+}
+
+}  // namespace jpp
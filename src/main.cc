@@ -8,8 +8,712 @@
  * @copyright Copyright (c) 2023
  *
  */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <exception>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "decompress_reader.h"
+#include "formatter.h"
+#include "json.h"
+
+namespace {
+
+// input is handed to workers and formatter in blocks of about this size
+constexpr std::size_t kBlockSize = 4 << 20;
+// buffered output is flushed once it grows past this size
+constexpr std::size_t kFlushSize = 1 << 20;
+
+const char* kUsage =
+    "usage: jpp <validate|minify|pretty|stats> [options] <file|->\n"
+    "\n"
+    "  validate  check that input is valid JSON\n"
+    "  minify    drop insignificant whitespace (streaming, input is not\n"
+    "            validated)\n"
+    "  pretty    indent by two spaces (streaming, input is not validated)\n"
+    "  stats     count values by type\n"
+    "\n"
+    "options:\n"
+    "  --ndjson       one JSON document per line\n"
+    "  --threads <n>  worker threads for --ndjson input\n"
+    "  --bench        report throughput on stderr\n"
+    "\n"
+    "gzip and zstd compressed files are read directly when support was\n"
+    "built in, they are decompressed on a separate thread.\n";
+
+enum class Command { Validate, Minify, Pretty, Stats };
+
+struct Arguments {
+  Command command = Command::Validate;
+  std::string path = "-";
+  bool ndjson = false;
+  bool bench = false;
+  std::size_t threads = 1;
+};
+
+const char* ResultName(jpp::Result result) {
+  switch (result) {
+    case jpp::Result::OK:
+      return "ok";
+    case jpp::Result::ExpectValue:
+      return "expect value";
+    case jpp::Result::InvalidValue:
+      return "invalid value";
+    case jpp::Result::RootNotSingular:
+      return "root not singular";
+    case jpp::Result::NumberTooBig:
+      return "number too big";
+    case jpp::Result::MissingQuotationMark:
+      return "missing quotation mark";
+    case jpp::Result::InvalidStringEscape:
+      return "invalid string escape";
+    case jpp::Result::InvalidStringCharacter:
+      return "invalid string character";
+    case jpp::Result::MissingCommaOrSquareBracket:
+      return "missing comma or square bracket";
+    case jpp::Result::MissingKey:
+      return "missing key";
+    case jpp::Result::MissingColon:
+      return "missing colon";
+    case jpp::Result::MissingCommaOrCurlyBracket:
+      return "missing comma or curly bracket";
+    case jpp::Result::NestingTooDeep:
+      return "nesting too deep";
+  }
+
+  return "unknown error";
+}
+
+Arguments ParseArguments(int argc, char** argv) {
+  if (argc < 2) {
+    throw std::invalid_argument(kUsage);
+  }
+
+  Arguments arguments;
+  std::string_view command = argv[1];
+  if (command == "validate") {
+    arguments.command = Command::Validate;
+  } else if (command == "minify") {
+    arguments.command = Command::Minify;
+  } else if (command == "pretty") {
+    arguments.command = Command::Pretty;
+  } else if (command == "stats") {
+    arguments.command = Command::Stats;
+  } else {
+    throw std::invalid_argument(kUsage);
+  }
+
+  bool has_path = false;
+  for (int i = 2; i < argc; ++i) {
+    std::string_view argument = argv[i];
+
+    if (argument == "--ndjson") {
+      arguments.ndjson = true;
+    } else if (argument == "--bench") {
+      arguments.bench = true;
+    } else if (argument == "--threads") {
+      if (++i == argc) {
+        throw std::invalid_argument("--threads expects a number");
+      }
+      char* end = nullptr;
+      long threads = std::strtol(argv[i], &end, 10);
+      if (*end != '\0' || threads < 1) {
+        throw std::invalid_argument("--threads expects a positive number");
+      }
+      arguments.threads = static_cast<std::size_t>(threads);
+    } else if (!has_path &&
+               (argument == "-" || argument.substr(0, 2) != "--")) {
+      arguments.path = argv[i];
+      has_path = true;
+    } else {
+      throw std::invalid_argument(kUsage);
+    }
+  }
+
+  if (arguments.threads > 1 && !arguments.ndjson) {
+    throw std::invalid_argument("--threads requires --ndjson");
+  }
+
+  return arguments;
+}
+
+/**
+ * @brief Whole input file, memory mapped where possible. Data is always
+ * followed by '\0' so the parser can run on it directly.
+ *
+ */
+class InputFile {
+ public:
+  explicit InputFile(const std::string& path) {
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("cannot open " + path);
+    }
+
+    struct stat status {};
+    if (fstat(fd, &status) == 0 && S_ISREG(status.st_mode)) {
+      length_ = static_cast<std::size_t>(status.st_size);
+      std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+
+      // the rest of the last page reads as zero, which is the '\0' the
+      // parser stops at. A file that fills its last page has no such byte.
+      if (length_ > 0 && length_ % page != 0) {
+        void* mapped = mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+          madvise(mapped, length_, MADV_SEQUENTIAL);
+          mapped_ = mapped;
+          data_ = static_cast<const char*>(mapped);
+          close(fd);
+          return;
+        }
+      }
+    }
+    close(fd);
+#endif
+    ReadAll(path);
+  }
+
+  ~InputFile() {
+#ifndef _WIN32
+    if (mapped_ != nullptr) {
+      munmap(mapped_, length_);
+    }
+#endif
+  }
+
+  InputFile(const InputFile&) = delete;
+  InputFile& operator=(const InputFile&) = delete;
+
+  const char* Data() const noexcept { return data_; }
+  std::size_t Length() const noexcept { return length_; }
+
+ private:
+  void ReadAll(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+      throw std::runtime_error("cannot open " + path);
+    }
+
+    char chunk[1 << 16];
+    std::size_t read = 0;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+      buffer_.append(chunk, read);
+    }
+    std::fclose(file);
+
+    data_ = buffer_.c_str();
+    length_ = buffer_.size();
+  }
+
+  const char* data_ = nullptr;
+  std::size_t length_ = 0;
+  void* mapped_ = nullptr;
+  std::string buffer_;
+};
+
+/**
+ * @brief Check whether path names a compressed file, pipes are never
+ * taken for one and are read as they come
+ *
+ */
+bool IsCompressed(const std::string& path) {
+  return path != "-" && jpp::DecompressReader::Detect(path.c_str()) !=
+                            jpp::Compression::None;
+}
+
+/**
+ * @brief Memory behind a block of BlockReader, the block stays valid until
+ * the storage is passed to BlockReader::Next again
+ *
+ */
+struct BlockStorage {
+  // stdin input, read in without zeroing the buffer first
+  std::unique_ptr<char[]> data;
+  std::size_t capacity = 0;
+  // decompressed input, a buffer of the reader's ring
+  jpp::DecompressReader::Chunk chunk;
+
+  // make room for needed bytes, keeping the first length bytes
+  char* Reserve(std::size_t length, std::size_t needed) {
+    if (needed > capacity) {
+      std::size_t grown = std::max(needed, capacity + capacity / 2);
+      std::unique_ptr<char[]> buffer(new char[grown]);
+      if (length > 0) {
+        std::memcpy(buffer.get(), data.get(), length);
+      }
+      data = std::move(buffer);
+      capacity = grown;
+    }
+
+    return data.get();
+  }
+};
+
+/**
+ * @brief Produces input as blocks, from a mapped file, a decompressing
+ * reader or by reading stdin. With whole_lines set, a block always ends
+ * right after a '\n' (or at the end of input), so no line is split between
+ * blocks.
+ *
+ */
+class BlockReader {
+ public:
+  BlockReader(const std::string& path, bool whole_lines)
+      : whole_lines_(whole_lines) {
+    if (IsCompressed(path)) {
+      decompress_.reset(new jpp::DecompressReader(whole_lines, kBlockSize));
+      if (!decompress_->Open(path.c_str())) {
+        throw std::runtime_error(decompress_->Error());
+      }
+    } else if (path != "-") {
+      file_.reset(new InputFile(path));
+    }
+  }
+
+  /**
+   * @brief Get the next block, stdin and decompressed blocks are held by
+   * storage
+   *
+   * @param storage
+   * @param block
+   * @return false at end of input
+   */
+  bool Next(BlockStorage* storage, std::string_view* block) {
+    if (decompress_ != nullptr) {
+      return NextDecompressed(&storage->chunk, block);
+    }
+    if (file_ != nullptr) {
+      return NextMapped(block);
+    }
+
+    return NextStdin(storage, block);
+  }
+
+  std::size_t BytesRead() const noexcept {
+    return decompress_ != nullptr ? decompress_->BytesRead() : bytes_read_;
+  }
+
+ private:
+  bool NextDecompressed(jpp::DecompressReader::Chunk* chunk,
+                        std::string_view* block) {
+    // chunk is swapped with a ring buffer, the next block is decompressed
+    // while this one is parsed
+    if (!decompress_->Next(chunk)) {
+      if (!decompress_->Error().empty()) {
+        throw std::runtime_error(decompress_->Error());
+      }
+      return false;
+    }
+
+    *block = chunk->View();
+
+    return true;
+  }
+
+  bool NextMapped(std::string_view* block) {
+    std::size_t length = file_->Length();
+    if (offset_ >= length) {
+      return false;
+    }
+
+    const char* data = file_->Data();
+    std::size_t end = std::min(length, offset_ + kBlockSize);
+    if (whole_lines_ && end < length) {
+      const void* newline = std::memchr(data + end, '\n', length - end);
+      end = newline == nullptr
+                ? length
+                : static_cast<std::size_t>(
+                      static_cast<const char*>(newline) - data + 1);
+    }
+
+    *block = std::string_view(data + offset_, end - offset_);
+    bytes_read_ += end - offset_;
+    offset_ = end;
+
+    return true;
+  }
+
+  bool NextStdin(BlockStorage* storage, std::string_view* block) {
+    std::size_t length = carry_.size();
+    char* data = storage->Reserve(0, std::max(length, kBlockSize));
+    if (length > 0) {
+      std::memcpy(data, carry_.data(), length);
+    }
+    carry_.clear();
+
+    // carry holds no '\n', only bytes read since are searched
+    std::size_t searched = length;
+    for (;;) {
+      if (length >= kBlockSize) {
+        if (!whole_lines_) {
+          break;
+        }
+
+        std::size_t newline = length;
+        while (newline > searched && data[newline - 1] != '\n') {
+          --newline;
+        }
+        if (newline > searched) {
+          carry_.assign(data + newline, length - newline);
+          length = newline;
+          break;
+        }
+        // a line longer than a block, keep reading until it ends like
+        // mapped and decompressed input do
+        searched = length;
+      }
+      if (eof_) {
+        break;
+      }
+
+      data = storage->Reserve(length, length + kBlockSize);
+      std::size_t read = std::fread(data + length, 1, kBlockSize, stdin);
+      length += read;
+      bytes_read_ += read;
+      if (read == 0) {
+        eof_ = true;
+      }
+    }
+
+    *block = std::string_view(data, length);
+
+    return length > 0;
+  }
+
+  bool whole_lines_;
+  std::unique_ptr<jpp::DecompressReader> decompress_;
+  std::unique_ptr<InputFile> file_;
+  std::size_t offset_ = 0;
+  std::string carry_;
+  bool eof_ = false;
+  std::size_t bytes_read_ = 0;
+};
+
+struct Stats {
+  std::size_t documents = 0;
+  std::size_t nulls = 0;
+  std::size_t booleans = 0;
+  std::size_t numbers = 0;
+  std::size_t strings = 0;
+  std::size_t arrays = 0;
+  std::size_t objects = 0;
+  std::size_t members = 0;
+  std::size_t string_bytes = 0;
+  std::size_t max_depth = 0;
+
+  void Merge(const Stats& other) {
+    documents += other.documents;
+    nulls += other.nulls;
+    booleans += other.booleans;
+    numbers += other.numbers;
+    strings += other.strings;
+    arrays += other.arrays;
+    objects += other.objects;
+    members += other.members;
+    string_bytes += other.string_bytes;
+    max_depth = std::max(max_depth, other.max_depth);
+  }
+};
+
+void CollectStats(const jpp::Value* root, Stats* stats) {
+  std::vector<std::pair<const jpp::Value*, std::size_t>> pending;
+  pending.emplace_back(root, 0);
+  ++stats->documents;
+
+  while (!pending.empty()) {
+    auto [value, depth] = pending.back();
+    pending.pop_back();
+
+    switch (jpp::JSON::GetType(value)) {
+      case jpp::Type::Null:
+        ++stats->nulls;
+        break;
+      case jpp::Type::False:
+      case jpp::Type::True:
+        ++stats->booleans;
+        break;
+      case jpp::Type::Number:
+        ++stats->numbers;
+        break;
+      case jpp::Type::String:
+        ++stats->strings;
+        stats->string_bytes += jpp::JSON::GetStringLength(value);
+        break;
+      case jpp::Type::Array:
+        ++stats->arrays;
+        stats->max_depth = std::max(stats->max_depth, depth + 1);
+        for (std::size_t i = 0; i < jpp::JSON::GetArraySize(value); ++i) {
+          pending.emplace_back(jpp::JSON::GetArrayElement(value, i),
+                               depth + 1);
+        }
+        break;
+      case jpp::Type::Object:
+        ++stats->objects;
+        stats->max_depth = std::max(stats->max_depth, depth + 1);
+        stats->members += jpp::JSON::GetObjectSize(value);
+        for (std::size_t i = 0; i < jpp::JSON::GetObjectSize(value); ++i) {
+          pending.emplace_back(jpp::JSON::GetObjectValue(value, i), depth + 1);
+        }
+        break;
+    }
+  }
+}
+
+void PrintStats(const Stats& stats) {
+  std::printf(
+      "documents     %zu\n"
+      "nulls         %zu\n"
+      "booleans      %zu\n"
+      "numbers       %zu\n"
+      "strings       %zu\n"
+      "string bytes  %zu\n"
+      "arrays        %zu\n"
+      "objects       %zu\n"
+      "members       %zu\n"
+      "max depth     %zu\n",
+      stats.documents, stats.nulls, stats.booleans, stats.numbers,
+      stats.strings, stats.string_bytes, stats.arrays, stats.objects,
+      stats.members, stats.max_depth);
+}
+
+void Write(std::string* out) {
+  std::fwrite(out->data(), 1, out->size(), stdout);
+  out->clear();
+}
+
+jpp::Options ParseOptions() {
+  jpp::Options options;
+  // nothing here reads numbers, only their syntax is checked
+  options.lazy_numbers = true;
+
+  return options;
+}
+
+/**
+ * @brief Work of one thread on one block of NDJSON lines
+ *
+ */
+struct LineWorker {
+  Command command;
+  std::string_view block;
+  std::size_t first_line;
+  std::string out;
+  Stats stats;
+  std::string error;
+
+  void Run() {
+    std::string line;
+    jpp::Value value;
+    jpp::Options options = ParseOptions();
+    std::size_t number = first_line;
+
+    std::size_t begin = 0;
+    while (begin < block.size() && error.empty()) {
+      std::size_t end = block.find('\n', begin);
+      if (end == std::string_view::npos) {
+        end = block.size();
+      }
+      std::string_view text = block.substr(begin, end - begin);
+      begin = end + 1;
+      ++number;
+
+      if (!text.empty() && text.back() == '\r') {
+        text.remove_suffix(1);
+      }
+      if (text.find_first_not_of(" \t\r") == std::string_view::npos) {
+        continue;
+      }
+
+      if (command == Command::Minify || command == Command::Pretty) {
+        // fresh state per line, a broken line cannot affect the next one
+        jpp::Formatter formatter(command == Command::Pretty, &out);
+        formatter.Feed(text);
+        formatter.Finish();
+        if (command == Command::Minify) {
+          out.push_back('\n');
+        }
+        continue;
+      }
+
+      // the parser would stop at a '\0' and accept what comes before it
+      std::size_t nul = text.find('\0');
+      if (nul != std::string_view::npos) {
+        error = "line " + std::to_string(number) +
+                ": unexpected '\\0' at column " + std::to_string(nul + 1);
+        break;
+      }
+
+      // parser needs a terminating '\0'
+      line.assign(text.data(), text.size());
+      jpp::Result result = jpp::JSON::Parse(&value, line.c_str(), options);
+      if (result != jpp::Result::OK) {
+        error = "line " + std::to_string(number) + ": " + ResultName(result);
+        break;
+      }
+      if (command == Command::Stats) {
+        CollectStats(&value, &stats);
+      } else {
+        ++stats.documents;
+      }
+    }
+  }
+};
+
+/**
+ * @brief Run command over NDJSON input, blocks of lines are spread over the
+ * worker threads and their output is written back in input order
+ *
+ */
+int RunLines(const Arguments& arguments, std::size_t* bytes) {
+  BlockReader reader(arguments.path, true);
+  std::vector<BlockStorage> storage(arguments.threads);
+  std::vector<LineWorker> workers(arguments.threads);
+  std::size_t lines = 0;
+  Stats total;
+
+  for (;;) {
+    std::size_t count = 0;
+    while (count < workers.size()) {
+      std::string_view block;
+      if (!reader.Next(&storage[count], &block)) {
+        break;
+      }
+
+      LineWorker& worker = workers[count];
+      worker.command = arguments.command;
+      worker.block = block;
+      worker.first_line = lines;
+      worker.out.clear();
+      worker.stats = Stats{};
+      worker.error.clear();
+      lines += static_cast<std::size_t>(
+          std::count(block.begin(), block.end(), '\n'));
+      ++count;
+    }
+    if (count == 0) {
+      break;
+    }
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < count; ++i) {
+      threads.emplace_back(&LineWorker::Run, &workers[i]);
+    }
+    workers[0].Run();
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    *bytes = reader.BytesRead();
+    for (std::size_t i = 0; i < count; ++i) {
+      Write(&workers[i].out);
+      if (!workers[i].error.empty()) {
+        std::cerr << workers[i].error << '\n';
+        return EXIT_FAILURE;
+      }
+      total.Merge(workers[i].stats);
+    }
+  }
+
+  if (arguments.command == Command::Stats) {
+    PrintStats(total);
+  } else if (arguments.command == Command::Validate) {
+    std::printf("ok, %zu documents\n", total.documents);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Run command over a single JSON document
+ *
+ */
+int RunDocument(const Arguments& arguments, std::size_t* bytes) {
+  // formatting streams block by block
+  if (arguments.command == Command::Minify ||
+      arguments.command == Command::Pretty) {
+    BlockReader reader(arguments.path, false);
+    BlockStorage storage;
+    std::string_view block;
+    std::string out;
+    jpp::Formatter formatter(arguments.command == Command::Pretty, &out);
+
+    while (reader.Next(&storage, &block)) {
+      for (std::size_t i = 0; i < block.size(); i += kFlushSize) {
+        formatter.Feed(block.substr(i, kFlushSize));
+        Write(&out);
+      }
+    }
+    formatter.Finish();
+    Write(&out);
+    *bytes = reader.BytesRead();
+
+    return EXIT_SUCCESS;
+  }
+
+  // the parser needs the whole document, a mapped file is used in place
+  std::unique_ptr<InputFile> file;
+  std::string buffer;
+  const char* json = nullptr;
+  if (arguments.path == "-" || IsCompressed(arguments.path)) {
+    BlockReader reader(arguments.path, false);
+    BlockStorage storage;
+    std::string_view block;
+    while (reader.Next(&storage, &block)) {
+      buffer.append(block);
+    }
+    json = buffer.c_str();
+    *bytes = buffer.size();
+  } else {
+    file.reset(new InputFile(arguments.path));
+    json = file->Data();
+    *bytes = file->Length();
+  }
+
+  // the parser would stop at a '\0' and accept what comes before it
+  const void* nul = std::memchr(json, '\0', *bytes);
+  if (nul != nullptr) {
+    std::cerr << "unexpected '\\0' at offset "
+              << static_cast<const char*>(nul) - json << '\n';
+    return EXIT_FAILURE;
+  }
+
+  jpp::Value value;
+  jpp::Result result = jpp::JSON::Parse(&value, json, ParseOptions());
+  if (result != jpp::Result::OK) {
+    std::cerr << ResultName(result) << '\n';
+    return EXIT_FAILURE;
+  }
+
+  if (arguments.command == Command::Stats) {
+    Stats stats;
+    CollectStats(&value, &stats);
+    PrintStats(stats);
+  } else {
+    std::printf("ok\n");
+  }
+
+  return EXIT_SUCCESS;
+}
+
+}  // namespace
 
 int main(int argc, char** argv) {
   if (!argc || !argv) {
@@ -17,6 +721,23 @@ int main(int argc, char** argv) {
   }
 
   try {
+    Arguments arguments = ParseArguments(argc, argv);
+    auto start = std::chrono::steady_clock::now();
+
+    std::size_t bytes = 0;
+    int status = arguments.ndjson ? RunLines(arguments, &bytes)
+                                  : RunDocument(arguments, &bytes);
+    std::fflush(stdout);
+
+    if (arguments.bench) {
+      std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
+      double megabytes = static_cast<double>(bytes) / 1e6;
+      std::fprintf(stderr, "%.1f MB in %.3f s, %.1f MB/s\n", megabytes,
+                   elapsed.count(), megabytes / elapsed.count());
+    }
+
+    return status;
   } catch (const std::exception& e) {
     std::cerr << e.what() << '\n';
 
@@ -24,4 +745,4 @@ int main(int argc, char** argv) {
   }
 
   return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -0,0 +1,243 @@
+/**
+ * @file shared_document.cc
+ * @author Mao Zhang (mao.zhang233@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "shared_document.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <thread>
+#include <utility>
+
+namespace jpp {
+
+FrozenDocument::FrozenDocument(Document&& document)
+    : document_(std::move(document)) {
+  Freeze(true);
+}
+
+void FrozenDocument::Freeze(bool detach) {
+  // GetNumber writes its cache on first call, do it now while not shared
+  std::vector<const Value*> pending;
+  pending.push_back(&document_.Root());
+
+  while (!pending.empty()) {
+    const Value* value = pending.back();
+    pending.pop_back();
+
+    switch (JSON::GetType(value)) {
+      case Type::Number:
+        JSON::GetNumber(value);
+        if (detach) {
+          const_cast<Value*>(value)->number.lexeme = nullptr;
+          const_cast<Value*>(value)->number.length = 0;
+        }
+        break;
+      case Type::Array:
+        for (std::size_t i = 0; i < JSON::GetArraySize(value); ++i) {
+          pending.push_back(JSON::GetArrayElement(value, i));
+        }
+        break;
+      case Type::Object:
+        for (std::size_t i = 0; i < JSON::GetObjectSize(value); ++i) {
+          pending.push_back(JSON::GetObjectValue(value, i));
+        }
+        break;
+      default:
+        break;
+    }
+  }
+
+  hash_ = document_.Hash();
+}
+
+bool operator==(const FrozenDocument& lhs, const FrozenDocument& rhs) {
+  return JSON::Equal(&lhs.Root(), lhs.Hash(), &rhs.Root(), rhs.Hash());
+}
+
+bool operator!=(const FrozenDocument& lhs, const FrozenDocument& rhs) {
+  return !(lhs == rhs);
+}
+
+SharedDocument::Guard::~Guard() { Reset(); }
+
+SharedDocument::Guard::Guard(Guard&& other) noexcept
+    : owner_(other.owner_), slot_(other.slot_), document_(other.document_) {
+  other.owner_ = nullptr;
+  other.document_ = nullptr;
+}
+
+SharedDocument::Guard& SharedDocument::Guard::operator=(
+    Guard&& other) noexcept {
+  if (this != &other) {
+    Reset();
+    owner_ = other.owner_;
+    slot_ = other.slot_;
+    document_ = other.document_;
+    other.owner_ = nullptr;
+    other.document_ = nullptr;
+  }
+
+  return *this;
+}
+
+void SharedDocument::Guard::Reset() noexcept {
+  if (owner_ != nullptr) {
+    owner_->Release(slot_);
+    owner_ = nullptr;
+  }
+  document_ = nullptr;
+}
+
+SharedDocument::SharedDocument(std::size_t max_readers)
+    : current_(nullptr),
+      slots_(new Slot[std::max<std::size_t>(max_readers, 1)]),
+      slot_count_(std::max<std::size_t>(max_readers, 1)) {}
+
+SharedDocument::~SharedDocument() {
+  for (std::size_t i = 0; i < slot_count_; ++i) {
+    assert(!slots_[i].used.load() && "guard outlives shared document");
+  }
+
+  delete current_.load();
+  for (const FrozenDocument* document : retired_) {
+    delete document;
+  }
+}
+
+SharedDocument::Guard SharedDocument::Pin() {
+  // threads start looking at different slots to avoid contention
+  std::size_t start =
+      std::hash<std::thread::id>{}(std::this_thread::get_id()) % slot_count_;
+
+  for (;;) {
+    for (std::size_t n = 0; n < slot_count_; ++n) {
+      std::size_t index = (start + n) % slot_count_;
+      Slot& slot = slots_[index];
+
+      bool expected = false;
+      if (slot.used.load(std::memory_order_relaxed) ||
+          !slot.used.compare_exchange_strong(expected, true,
+                                             std::memory_order_acquire)) {
+        continue;
+      }
+
+      // publish the hazard, then make sure it is still current: a writer
+      // that swapped in between will see the hazard when reclaiming
+      const FrozenDocument* document = current_.load();
+      for (;;) {
+        slot.hazard.store(document);
+        const FrozenDocument* again = current_.load();
+        if (again == document) {
+          break;
+        }
+        document = again;
+      }
+
+      return Guard(this, index, document);
+    }
+
+    // more guards alive than slots, wait for one to be released
+    std::this_thread::yield();
+  }
+}
+
+void SharedDocument::Release(std::size_t slot) noexcept {
+  slots_[slot].hazard.store(nullptr);
+  slots_[slot].used.store(false, std::memory_order_release);
+
+  // freeing a large snapshot takes long, readers leave that to writers
+}
+
+void SharedDocument::Store(Document&& document) {
+  Publish(new FrozenDocument(std::move(document)));
+}
+
+Result SharedDocument::Load(const char* json, const Options& options) {
+  std::unique_ptr<FrozenDocument> frozen(new FrozenDocument());
+
+  // lazy numbers keep pointing into the snapshot's own copy of the text
+  frozen->source_.assign(json);
+  Result result = frozen->document_.Parse(frozen->source_.c_str(), options);
+  if (result != Result::OK) {
+    return result;
+  }
+  frozen->Freeze(false);
+
+  Publish(frozen.release());
+
+  return Result::OK;
+}
+
+void SharedDocument::Publish(const FrozenDocument* document) {
+  std::vector<const FrozenDocument*> unpinned;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const FrozenDocument* previous = current_.exchange(document);
+    if (previous != nullptr) {
+      retired_.push_back(previous);
+    }
+
+    unpinned = TakeUnpinnedLocked();
+  }
+
+  // other writers do not wait for the deletes
+  for (const FrozenDocument* retired : unpinned) {
+    delete retired;
+  }
+}
+
+void SharedDocument::Reclaim() {
+  std::vector<const FrozenDocument*> unpinned;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    unpinned = TakeUnpinnedLocked();
+  }
+
+  for (const FrozenDocument* retired : unpinned) {
+    delete retired;
+  }
+}
+
+std::size_t SharedDocument::RetiredCount() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  return retired_.size();
+}
+
+std::vector<const FrozenDocument*> SharedDocument::TakeUnpinnedLocked() {
+  std::vector<const FrozenDocument*> unpinned;
+  if (retired_.empty()) {
+    return unpinned;
+  }
+
+  std::vector<const FrozenDocument*> hazards;
+  for (std::size_t i = 0; i < slot_count_; ++i) {
+    const FrozenDocument* hazard = slots_[i].hazard.load();
+    if (hazard != nullptr) {
+      hazards.push_back(hazard);
+    }
+  }
+
+  auto pinned = [&hazards](const FrozenDocument* document) {
+    return std::find(hazards.begin(), hazards.end(), document) !=
+           hazards.end();
+  };
+
+  auto first = std::partition(retired_.begin(), retired_.end(), pinned);
+  unpinned.assign(first, retired_.end());
+  retired_.erase(first, retired_.end());
+
+  return unpinned;
+}
+
+}  // namespace jpp
@@ -0,0 +1,192 @@
+/**
+ * @file cli.test.cc
+ * @author Mao Zhang (mao.zhang233@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#endif
+
+// runs the jpp executable, which is built next to the tests
+#if defined(JPP_BINARY) && !defined(_WIN32)
+
+namespace {
+
+void WriteFile(const std::string& path, const std::string& data) {
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  ASSERT_NE(nullptr, file);
+  std::fwrite(data.data(), 1, data.size(), file);
+  std::fclose(file);
+}
+
+// run jpp with arguments, return its exit status and stdout and stderr.
+// The output of input, a shell command, is piped into jpp.
+int RunJpp(const std::string& arguments, std::string* output,
+           const std::string& input = "") {
+  std::string command = std::string(JPP_BINARY) + " " + arguments + " 2>&1";
+  if (!input.empty()) {
+    command = input + " | " + command;
+  }
+  std::FILE* pipe = popen(command.c_str(), "r");
+  if (pipe == nullptr) {
+    return -1;
+  }
+
+  output->clear();
+  char chunk[1 << 16];
+  std::size_t read = 0;
+  while ((read = std::fread(chunk, 1, sizeof(chunk), pipe)) > 0) {
+    output->append(chunk, read);
+  }
+
+  int status = pclose(pipe);
+
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+}  // namespace
+
+TEST(CliTest, Arguments) {
+  std::string output;
+  EXPECT_NE(0, RunJpp("", &output));
+  EXPECT_NE(std::string::npos, output.find("usage: jpp"));
+  EXPECT_NE(0, RunJpp("format x.json", &output));
+  EXPECT_NE(std::string::npos, output.find("usage: jpp"));
+  EXPECT_NE(0, RunJpp("validate a.json b.json", &output));
+  EXPECT_NE(std::string::npos, output.find("usage: jpp"));
+  EXPECT_NE(0, RunJpp("validate --color x.json", &output));
+  EXPECT_NE(std::string::npos, output.find("usage: jpp"));
+
+  EXPECT_NE(0, RunJpp("validate --ndjson --threads", &output));
+  EXPECT_EQ("--threads expects a number\n", output);
+  EXPECT_NE(0, RunJpp("validate --ndjson --threads 0 -", &output));
+  EXPECT_EQ("--threads expects a positive number\n", output);
+  EXPECT_NE(0, RunJpp("validate --threads 2 -", &output));
+  EXPECT_EQ("--threads requires --ndjson\n", output);
+
+  EXPECT_NE(0, RunJpp("validate no_such_file.json", &output));
+  EXPECT_EQ("cannot open no_such_file.json\n", output);
+}
+
+TEST(CliTest, Document) {
+  std::string path = testing::TempDir() + "jpp_cli.json";
+  WriteFile(path, "{ \"a\": [1, 2] }\n");
+
+  std::string output;
+  EXPECT_EQ(0, RunJpp("validate " + path, &output));
+  EXPECT_EQ("ok\n", output);
+  EXPECT_EQ(0, RunJpp("validate - < " + path, &output));
+  EXPECT_EQ("ok\n", output);
+  EXPECT_EQ(0, RunJpp("minify " + path, &output));
+  EXPECT_EQ("{\"a\":[1,2]}", output);
+
+  WriteFile(path, "[1, 2");
+  EXPECT_NE(0, RunJpp("validate " + path, &output));
+  EXPECT_EQ("missing comma or square bracket\n", output);
+
+  // the parser must not stop at an embedded '\0' and accept the prefix
+  WriteFile(path, std::string("[1,2]\0garbage", 13));
+  EXPECT_NE(0, RunJpp("validate " + path, &output));
+  EXPECT_EQ("unexpected '\\0' at offset 5\n", output);
+  EXPECT_NE(0, RunJpp("stats - < " + path, &output));
+  EXPECT_EQ("unexpected '\\0' at offset 5\n", output);
+
+  std::remove(path.c_str());
+}
+
+TEST(CliTest, Pipe) {
+  std::string path = testing::TempDir() + "jpp_cli_pipe.json";
+  WriteFile(path, "{ \"a\": [1, 2] }\n");
+
+  // a pipe given by path must be read once, not sniffed for compression
+  // first
+  std::string output;
+  EXPECT_EQ(0, RunJpp("validate /dev/stdin", &output, "cat " + path));
+  EXPECT_EQ("ok\n", output);
+  EXPECT_EQ(0, RunJpp("minify /dev/stdin", &output, "cat " + path));
+  EXPECT_EQ("{\"a\":[1,2]}", output);
+  EXPECT_EQ(0, RunJpp("validate --ndjson /dev/stdin", &output,
+                      "cat " + path + " " + path));
+  EXPECT_EQ("ok, 2 documents\n", output);
+
+  std::remove(path.c_str());
+}
+
+TEST(CliTest, Lines) {
+  std::string path = testing::TempDir() + "jpp_cli.ndjson";
+  WriteFile(path, "{\"a\": 1}\n\n[true]\r\n");
+
+  std::string output;
+  EXPECT_EQ(0, RunJpp("validate --ndjson " + path, &output));
+  EXPECT_EQ("ok, 2 documents\n", output);
+  EXPECT_EQ(0, RunJpp("minify --ndjson " + path, &output));
+  EXPECT_EQ("{\"a\":1}\n[true]\n", output);
+
+  WriteFile(path, std::string("[1]\n[2]\0x\n[3]\n", 13));
+  EXPECT_NE(0, RunJpp("validate --ndjson " + path, &output));
+  EXPECT_EQ("line 2: unexpected '\\0' at column 4\n", output);
+
+  std::remove(path.c_str());
+}
+
+TEST(CliTest, LongLines) {
+  // lines longer than a 4 MB block must not be split, whatever the input
+  std::string input = "[\"" + std::string(9 << 20, 'x') + "\"]\n[1]\n" +
+                      "{\"a\":\"" + std::string(5 << 20, 'y') + "\"}";
+  std::string path = testing::TempDir() + "jpp_cli_long.ndjson";
+  WriteFile(path, input);
+
+  std::string output;
+  EXPECT_EQ(0, RunJpp("validate --ndjson " + path, &output));
+  EXPECT_EQ("ok, 3 documents\n", output);
+  EXPECT_EQ(0, RunJpp("validate --ndjson -", &output, "cat " + path));
+  EXPECT_EQ("ok, 3 documents\n", output);
+  EXPECT_EQ(0, RunJpp("validate --ndjson --threads 2 - < " + path, &output));
+  EXPECT_EQ("ok, 3 documents\n", output);
+  EXPECT_EQ(0, RunJpp("minify --ndjson -", &output, "cat " + path));
+  EXPECT_TRUE(output == input + "\n");
+
+  std::remove(path.c_str());
+}
+
+TEST(CliTest, LinesInOrder) {
+  // several blocks of lines, so every worker thread gets some
+  std::string input;
+  std::string expected;
+  for (int i = 0; i < 400000; ++i) {
+    std::string id = std::to_string(i);
+    input += "{ \"id\": " + id + ", \"tag\": \"line " + id + "\" }\n";
+    expected += "{\"id\":" + id + ",\"tag\":\"line " + id + "\"}\n";
+  }
+  ASSERT_GT(input.size(), static_cast<std::size_t>(3 * (4 << 20)));
+
+  std::string path = testing::TempDir() + "jpp_cli_order.ndjson";
+  WriteFile(path, input);
+
+  std::string output;
+  EXPECT_EQ(0, RunJpp("minify --ndjson --threads 4 " + path, &output));
+  EXPECT_TRUE(output == expected);
+  EXPECT_EQ(0, RunJpp("validate --ndjson --threads 4 - < " + path, &output));
+  EXPECT_EQ("ok, 400000 documents\n", output);
+
+  // the first error in input order is reported, whichever thread sees it
+  input.replace(input.find("\"id\": 123456,"), 1, "x");
+  input.replace(input.find("\"id\": 345678,"), 1, "x");
+  WriteFile(path, input);
+  EXPECT_NE(0, RunJpp("validate --ndjson --threads 4 " + path, &output));
+  EXPECT_EQ("line 123457: missing key\n", output);
+
+  std::remove(path.c_str());
+}
+
+#endif
@@ -0,0 +1,191 @@
+/**
+ * @file columnar.test.cc
+ * @author Mao Zhang (mao.zhang233@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "columnar.h"
+#include "json.h"
+
+namespace {
+
+std::vector<jpp::ColumnSpec> Specs() {
+  return {{"id", jpp::ColumnType::Int64},
+          {"user.name", jpp::ColumnType::String},
+          {"user.score", jpp::ColumnType::Double},
+          {"ok", jpp::ColumnType::Boolean}};
+}
+
+}  // namespace
+
+TEST(ColumnarTest, Extract) {
+  const char* ndjson =
+      "{\"id\": 1, \"user\": {\"name\": \"ann\", \"score\": 1.5}, "
+      "\"ok\": true}\n"
+      "\n"
+      "{\"skip\": [1, {\"x\": \"}\"}], \"id\": 9007199254740993, "
+      "\"user\": {\"score\": 2}}\r\n"
+      "{\"ok\": false, \"user\": {\"name\": \"a\\\"b\\n\"}, \"id\": 2.9}\n"
+      "{\"id\": \"3\", \"user\": null, \"ok\": 1, \"id\": 4}\n"
+      "[1, 2]";
+  jpp::ColumnExtractor extractor(Specs());
+  std::vector<jpp::Column> columns;
+  EXPECT_EQ(static_cast<std::size_t>(0), extractor.Extract(ndjson, &columns));
+  ASSERT_EQ(static_cast<std::size_t>(4), columns.size());
+
+  const jpp::Column& id = columns[0];
+  ASSERT_EQ(static_cast<std::size_t>(5), id.size);
+  EXPECT_EQ(static_cast<std::size_t>(2), id.null_count);
+  EXPECT_EQ(1, id.int64s[0]);
+  EXPECT_EQ(INT64_C(9007199254740993), id.int64s[1]);
+  EXPECT_EQ(2, id.int64s[2]);
+  // the first of duplicate keys counts even when mistyped
+  EXPECT_FALSE(id.IsValid(3));
+  EXPECT_FALSE(id.IsValid(4));
+
+  const jpp::Column& name = columns[1];
+  ASSERT_EQ(static_cast<std::size_t>(5), name.size);
+  EXPECT_EQ("ann", name.GetString(0));
+  EXPECT_FALSE(name.IsValid(1));
+  EXPECT_EQ("", name.GetString(1));
+  EXPECT_EQ("a\"b\n", name.GetString(2));
+  EXPECT_FALSE(name.IsValid(3));
+
+  const jpp::Column& score = columns[2];
+  EXPECT_DOUBLE_EQ(1.5, score.doubles[0]);
+  EXPECT_DOUBLE_EQ(2.0, score.doubles[1]);
+  EXPECT_EQ(static_cast<std::size_t>(3), score.null_count);
+
+  const jpp::Column& ok = columns[3];
+  EXPECT_TRUE(ok.IsValid(0));
+  EXPECT_EQ(1, ok.booleans[0]);
+  EXPECT_TRUE(ok.IsValid(2));
+  EXPECT_EQ(0, ok.booleans[2]);
+  EXPECT_FALSE(ok.IsValid(3));
+}
+
+TEST(ColumnarTest, DuplicateKeys) {
+  const char* records[] = {
+      "{\"id\": \"1\", \"id\": 1}",
+      "{\"id\": 2, \"id\": 3}",
+      "{\"user\": {\"name\": \"a\"}, \"user\": {\"score\": 1}}",
+      "{\"user\": 5, \"user\": {\"name\": \"b\", \"score\": 2}}",
+      "{\"user\": {\"name\": 1, \"name\": \"c\", \"score\": 3}}",
+      "{\"ok\": null, \"ok\": true, \"user\": {}, \"user\": {}}",
+  };
+  std::string ndjson;
+  for (const char* record : records) {
+    ndjson += std::string(record) + "\n";
+  }
+
+  jpp::ColumnExtractor extractor(Specs());
+  std::vector<jpp::Column> columns;
+  EXPECT_EQ(static_cast<std::size_t>(0),
+            extractor.Extract(ndjson.c_str(), &columns));
+
+  // every field is what a lookup in the parsed record finds
+  std::size_t row = 0;
+  for (const char* record : records) {
+    jpp::Value value;
+    ASSERT_EQ(jpp::Result::OK, jpp::JSON::Parse(&value, record));
+
+    const jpp::Value* id = jpp::JSON::FindObjectValue(&value, "id", 2);
+    bool has_id =
+        id != nullptr && jpp::JSON::GetType(id) == jpp::Type::Number;
+    ASSERT_EQ(has_id, columns[0].IsValid(row)) << record;
+    if (has_id) {
+      EXPECT_EQ(jpp::JSON::GetNumber(id), columns[0].int64s[row]);
+    }
+
+    const jpp::Value* user = jpp::JSON::FindObjectValue(&value, "user", 4);
+    const jpp::Value* name = nullptr;
+    const jpp::Value* score = nullptr;
+    if (user != nullptr && jpp::JSON::GetType(user) == jpp::Type::Object) {
+      name = jpp::JSON::FindObjectValue(user, "name", 4);
+      score = jpp::JSON::FindObjectValue(user, "score", 5);
+    }
+    bool has_name =
+        name != nullptr && jpp::JSON::GetType(name) == jpp::Type::String;
+    ASSERT_EQ(has_name, columns[1].IsValid(row)) << record;
+    if (has_name) {
+      EXPECT_EQ(std::string_view(jpp::JSON::GetString(name)),
+                columns[1].GetString(row));
+    }
+    bool has_score =
+        score != nullptr && jpp::JSON::GetType(score) == jpp::Type::Number;
+    ASSERT_EQ(has_score, columns[2].IsValid(row)) << record;
+    if (has_score) {
+      EXPECT_EQ(jpp::JSON::GetNumber(score), columns[2].doubles[row]);
+    }
+
+    const jpp::Value* ok = jpp::JSON::FindObjectValue(&value, "ok", 2);
+    bool has_ok = ok != nullptr && (jpp::JSON::GetType(ok) == jpp::Type::True ||
+                                    jpp::JSON::GetType(ok) == jpp::Type::False);
+    EXPECT_EQ(has_ok, columns[3].IsValid(row)) << record;
+    ++row;
+  }
+}
+
+TEST(ColumnarTest, Invalid) {
+  const char* ndjson =
+      "{\"id\": 1, \"user\": {\"name\": \"x\"}, \"ok\": tru}\n"
+      "{\"id\": 2, \"user\": {\"name\": \"y\"}} trailing\n"
+      "{\"id\": 3, \"user\": {\"name\": \"z\\u0041\"}}\n"
+      "{\"id\": 4}";
+  jpp::ColumnExtractor extractor(Specs());
+  std::vector<jpp::Column> columns;
+  EXPECT_EQ(static_cast<std::size_t>(3), extractor.Extract(ndjson, &columns));
+
+  // broken records become null rows without leftovers
+  const jpp::Column& id = columns[0];
+  ASSERT_EQ(static_cast<std::size_t>(4), id.size);
+  EXPECT_EQ(static_cast<std::size_t>(3), id.null_count);
+  EXPECT_EQ(4, id.int64s[3]);
+  const jpp::Column& name = columns[1];
+  EXPECT_EQ(static_cast<std::size_t>(4), name.null_count);
+  EXPECT_TRUE(name.bytes.empty());
+}
+
+TEST(ColumnarTest, Parallel) {
+  std::string ndjson;
+  for (int i = 0; i < 1000; ++i) {
+    ndjson += "{\"id\": " + std::to_string(i);
+    if (i % 3 != 0) {
+      ndjson += ", \"user\": {\"name\": \"n" + std::to_string(i) + "\"}";
+    }
+    ndjson += i % 7 == 0 ? ", \"ok\": }\n" : "}\n";
+  }
+
+  jpp::ColumnExtractor serial(Specs());
+  std::vector<jpp::Column> expect;
+  std::size_t invalid = serial.Extract(ndjson.c_str(), &expect);
+  EXPECT_EQ(static_cast<std::size_t>(143), invalid);
+
+  jpp::ColumnExtractor parallel(Specs(), 7);
+  std::vector<jpp::Column> columns;
+  EXPECT_EQ(invalid, parallel.Extract(ndjson.c_str(), &columns));
+  // a second batch is appended behind the first
+  EXPECT_EQ(invalid, parallel.Extract(ndjson.c_str(), &columns));
+  serial.Extract(ndjson.c_str(), &expect);
+
+  for (std::size_t i = 0; i < columns.size(); ++i) {
+    EXPECT_EQ(expect[i].size, columns[i].size);
+    EXPECT_EQ(expect[i].null_count, columns[i].null_count);
+    EXPECT_EQ(expect[i].validity, columns[i].validity);
+    EXPECT_EQ(expect[i].int64s, columns[i].int64s);
+    EXPECT_EQ(expect[i].offsets, columns[i].offsets);
+    EXPECT_EQ(expect[i].bytes, columns[i].bytes);
+  }
+  EXPECT_EQ("n1", columns[1].GetString(1));
+}
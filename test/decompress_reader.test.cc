@@ -0,0 +1,206 @@
+/**
+ * @file decompress_reader.test.cc
+ * @author Mao Zhang (mao.zhang233@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#ifdef JPP_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef JPP_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "decompress_reader.h"
+#include "json.h"
+
+namespace {
+
+std::string Lines(int count) {
+  std::string text;
+  for (int i = 0; i < count; ++i) {
+    text += "{\"id\": " + std::to_string(i) + ", \"tag\": \"" +
+            std::string(static_cast<std::size_t>(i % 50), 'x') + "\"}\n";
+  }
+
+  return text;
+}
+
+void WriteFile(const std::string& path, const std::string& data) {
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  ASSERT_NE(nullptr, file);
+  std::fwrite(data.data(), 1, data.size(), file);
+  std::fclose(file);
+}
+
+// read all chunks, each must hold whole lines that parse on their own
+std::string ReadLines(jpp::DecompressReader* reader) {
+  std::string all;
+  jpp::DecompressReader::Chunk buffer;
+  jpp::Value value;
+  while (reader->Next(&buffer)) {
+    std::string_view chunk = buffer.View();
+    EXPECT_EQ('\n', chunk.back());
+    EXPECT_EQ('\0', buffer.Data()[buffer.Length()]);
+
+    std::size_t begin = 0;
+    while (begin < chunk.size()) {
+      std::size_t end = chunk.find('\n', begin);
+      std::string line(chunk.substr(begin, end - begin));
+      EXPECT_EQ(jpp::Result::OK, jpp::JSON::Parse(&value, line.c_str()));
+      begin = end + 1;
+    }
+    all += chunk;
+  }
+
+  return all;
+}
+
+}  // namespace
+
+TEST(DecompressReaderTest, Plain) {
+  std::string path = testing::TempDir() + "jpp_decompress_plain.ndjson";
+  std::string text = Lines(2000);
+  WriteFile(path, text);
+  EXPECT_EQ(jpp::Compression::None,
+            jpp::DecompressReader::Detect(path.c_str()));
+
+  // small buffers and a short ring keep the producer waiting on the consumer
+  jpp::DecompressReader reader(true, 100, 2);
+  ASSERT_TRUE(reader.Open(path.c_str()));
+  EXPECT_EQ(text, ReadLines(&reader));
+  EXPECT_TRUE(reader.Error().empty());
+  EXPECT_EQ(text.size(), reader.BytesRead());
+
+  jpp::DecompressReader raw(false, 1000, 3);
+  ASSERT_TRUE(raw.Open(path.c_str()));
+  std::string all;
+  jpp::DecompressReader::Chunk chunk;
+  while (raw.Next(&chunk)) {
+    all += chunk.View();
+  }
+  EXPECT_EQ(text, all);
+  std::remove(path.c_str());
+}
+
+TEST(DecompressReaderTest, Error) {
+  jpp::DecompressReader reader(true);
+  jpp::DecompressReader::Chunk chunk;
+  EXPECT_FALSE(reader.Next(&chunk));
+  EXPECT_FALSE(reader.Open("/nonexistent/jpp.json"));
+  EXPECT_FALSE(reader.Error().empty());
+}
+
+TEST(DecompressReaderTest, StopEarly) {
+  std::string path = testing::TempDir() + "jpp_decompress_stop.ndjson";
+  WriteFile(path, Lines(5000));
+
+  // destroying a reader with chunks still pending stops the producer
+  jpp::DecompressReader reader(true, 64, 2);
+  ASSERT_TRUE(reader.Open(path.c_str()));
+  jpp::DecompressReader::Chunk chunk;
+  EXPECT_TRUE(reader.Next(&chunk));
+  std::remove(path.c_str());
+}
+
+#ifdef JPP_HAVE_ZLIB
+TEST(DecompressReaderTest, Gzip) {
+  std::string path = testing::TempDir() + "jpp_decompress.ndjson.gz";
+  std::string text = Lines(3000);
+
+  // two members, as written by appending to a .gz file
+  gzFile file = gzopen(path.c_str(), "wb");
+  ASSERT_NE(nullptr, file);
+  gzwrite(file, text.data(), static_cast<unsigned>(text.size() / 2));
+  gzclose(file);
+  file = gzopen(path.c_str(), "ab");
+  ASSERT_NE(nullptr, file);
+  gzwrite(file, text.data() + text.size() / 2,
+          static_cast<unsigned>(text.size() - text.size() / 2));
+  gzclose(file);
+  EXPECT_EQ(jpp::Compression::Gzip,
+            jpp::DecompressReader::Detect(path.c_str()));
+
+  jpp::DecompressReader reader(true, 4096, 3);
+  ASSERT_TRUE(reader.Open(path.c_str()));
+  EXPECT_EQ(text, ReadLines(&reader));
+  EXPECT_TRUE(reader.Error().empty());
+
+  // cut the compressed file short
+  std::FILE* compressed = std::fopen(path.c_str(), "rb");
+  ASSERT_NE(nullptr, compressed);
+  std::string data(1 << 20, '\0');
+  data.resize(std::fread(&data[0], 1, data.size(), compressed));
+  std::fclose(compressed);
+  WriteFile(path, data.substr(0, data.size() / 4));
+
+  jpp::DecompressReader truncated(false);
+  ASSERT_TRUE(truncated.Open(path.c_str()));
+  jpp::DecompressReader::Chunk chunk;
+  while (truncated.Next(&chunk)) {
+  }
+  EXPECT_FALSE(truncated.Error().empty());
+  std::remove(path.c_str());
+}
+#endif
+
+#ifdef JPP_HAVE_ZSTD
+TEST(DecompressReaderTest, Zstd) {
+  std::string path = testing::TempDir() + "jpp_decompress.ndjson.zst";
+  std::string text = Lines(3000);
+
+  // two frames, as written by concatenating .zst files
+  std::string data;
+  for (std::string part :
+       {text.substr(0, text.size() / 2), text.substr(text.size() / 2)}) {
+    std::string frame(ZSTD_compressBound(part.size()), '\0');
+    std::size_t size = ZSTD_compress(&frame[0], frame.size(), part.data(),
+                                     part.size(), 1);
+    ASSERT_FALSE(ZSTD_isError(size));
+    data.append(frame, 0, size);
+  }
+  WriteFile(path, data);
+  EXPECT_EQ(jpp::Compression::Zstd,
+            jpp::DecompressReader::Detect(path.c_str()));
+
+  jpp::DecompressReader reader(true, 4096, 3);
+  ASSERT_TRUE(reader.Open(path.c_str()));
+  EXPECT_EQ(text, ReadLines(&reader));
+  EXPECT_TRUE(reader.Error().empty());
+  EXPECT_EQ(text.size(), reader.BytesRead());
+
+  // cut the last frame short, nothing of it may be taken for a record
+  WriteFile(path, data.substr(0, data.size() - 16));
+  jpp::DecompressReader truncated(false);
+  ASSERT_TRUE(truncated.Open(path.c_str()));
+  jpp::DecompressReader::Chunk chunk;
+  while (truncated.Next(&chunk)) {
+  }
+  EXPECT_EQ("zstd: truncated input", truncated.Error());
+  std::remove(path.c_str());
+}
+#else
+TEST(DecompressReaderTest, Unsupported) {
+  std::string path = testing::TempDir() + "jpp_decompress.ndjson.zst";
+  WriteFile(path, std::string("\x28\xb5\x2f\xfd", 4));
+  EXPECT_EQ(jpp::Compression::Zstd,
+            jpp::DecompressReader::Detect(path.c_str()));
+  EXPECT_FALSE(jpp::DecompressReader::Supported(jpp::Compression::Zstd));
+
+  jpp::DecompressReader reader(false);
+  EXPECT_FALSE(reader.Open(path.c_str()));
+  EXPECT_FALSE(reader.Error().empty());
+  std::remove(path.c_str());
+}
+#endif
@@ -0,0 +1,69 @@
+/**
+ * @file formatter.test.cc
+ * @author Mao Zhang (mao.zhang233@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+
+#include "formatter.h"
+
+namespace {
+
+std::string Format(bool pretty, std::string_view json) {
+  std::string out;
+  jpp::Formatter formatter(pretty, &out);
+  formatter.Feed(json);
+  formatter.Finish();
+
+  return out;
+}
+
+}  // namespace
+
+TEST(FormatterTest, Minify) {
+  EXPECT_EQ("{\"a\":[1,2,{}],\"b\":null}",
+            Format(false, " {\n \"a\" : [ 1 ,\t2, { } ] ,\r\n\"b\":null }\n"));
+  // whitespace and escaped quotes inside strings are kept
+  EXPECT_EQ("[\"a b\",\"\\\" x \\\\\",\"\\\\\"]",
+            Format(false, "[ \"a b\" , \"\\\" x \\\\\" , \"\\\\\" ]"));
+  EXPECT_EQ("", Format(false, " \n"));
+}
+
+TEST(FormatterTest, Pretty) {
+  EXPECT_EQ(
+      "{\n"
+      "  \"a\": [\n"
+      "    1,\n"
+      "    \"x, y\"\n"
+      "  ],\n"
+      "  \"b\": {},\n"
+      "  \"c\": []\n"
+      "}\n",
+      Format(true, "{\"a\":[1,\"x, y\"],\"b\":{ },\"c\":[]}"));
+  EXPECT_EQ("1\n", Format(true, " 1 "));
+}
+
+TEST(FormatterTest, Pieces) {
+  // a piece may end inside a string or right behind a backslash
+  const char* json = "{ \"k\\\"ey\" : [ \"v\\\\\" , { } , 1.5e3 ] }";
+
+  for (bool pretty : {false, true}) {
+    std::string expected = Format(pretty, json);
+
+    std::string out;
+    jpp::Formatter formatter(pretty, &out);
+    for (const char* p = json; *p != '\0'; ++p) {
+      formatter.Feed(std::string_view(p, 1));
+    }
+    formatter.Finish();
+    EXPECT_EQ(expected, out);
+  }
+}
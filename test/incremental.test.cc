@@ -0,0 +1,149 @@
+/**
+ * @file incremental.test.cc
+ * @author Mao Zhang (mao.zhang233@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+#include "incremental.h"
+#include "json.h"
+
+namespace {
+
+// apply edit to text and check the document against a full parse
+void ApplyEdit(jpp::IncrementalDocument* document, std::string* text,
+               const std::string& from, const std::string& to,
+               jpp::Result expect = jpp::Result::OK) {
+  std::size_t offset = text->find(from);
+  ASSERT_NE(std::string::npos, offset);
+  text->replace(offset, from.size(), to);
+
+  jpp::Edit edit{offset, from.size(), to.size()};
+  ASSERT_EQ(expect, document->Reparse(text->c_str(), edit));
+  if (expect != jpp::Result::OK) {
+    return;
+  }
+
+  jpp::Value value;
+  ASSERT_EQ(jpp::Result::OK, jpp::JSON::Parse(&value, text->c_str()));
+  EXPECT_TRUE(jpp::JSON::Equal(&value, &document->Root()));
+}
+
+}  // namespace
+
+TEST(IncrementalTest, LeafEdit) {
+  std::string text =
+      " { \"name\" : \"old\", \"list\" : [ 1, 2, { \"x\" : true } ], "
+      "\"n\" : null } ";
+  jpp::IncrementalDocument document;
+  ASSERT_EQ(jpp::Result::OK, document.Parse(text.c_str()));
+  EXPECT_EQ(text.size(), document.ReparsedLength());
+
+  ApplyEdit(&document, &text, "\"old\"", "\"renamed\"");
+  EXPECT_EQ(std::strlen("\"renamed\""), document.ReparsedLength());
+
+  // later siblings have moved, their spans must follow
+  ApplyEdit(&document, &text, "2", "200");
+  EXPECT_EQ(std::strlen("200"), document.ReparsedLength());
+  ApplyEdit(&document, &text, "true", "false");
+  EXPECT_EQ(std::strlen("false"), document.ReparsedLength());
+  ApplyEdit(&document, &text, "null", "-1.5e3");
+  EXPECT_EQ(std::strlen("-1.5e3"), document.ReparsedLength());
+  ApplyEdit(&document, &text, "\"renamed\"", "1");
+  ApplyEdit(&document, &text, "200", "[ ]");
+  EXPECT_EQ(std::strlen("[ ]"), document.ReparsedLength());
+  ApplyEdit(&document, &text, "[ ]", "[ 3, [ 4 ] ]");
+  ApplyEdit(&document, &text, "4", "\"four\"");
+  EXPECT_EQ(std::strlen("\"four\""), document.ReparsedLength());
+}
+
+TEST(IncrementalTest, WideContainer) {
+  std::string text = "[";
+  for (int i = 1000; i < 2000; ++i) {
+    text += (i == 1000 ? "" : ", ") + std::to_string(i);
+  }
+  text += "]";
+  jpp::IncrementalDocument document;
+  ASSERT_EQ(jpp::Result::OK, document.Parse(text.c_str()));
+
+  ApplyEdit(&document, &text, "1000", "-1");
+  EXPECT_EQ(std::strlen("-1"), document.ReparsedLength());
+  ApplyEdit(&document, &text, "1999", "[1999]");
+  EXPECT_EQ(std::strlen("[1999]"), document.ReparsedLength());
+  ApplyEdit(&document, &text, "1500", "\"x\"");
+  EXPECT_EQ(std::strlen("\"x\""), document.ReparsedLength());
+
+  // inserting right behind a value or right before it still finds it
+  std::size_t offset = text.find("1234") + 4;
+  text.insert(offset, "5");
+  ASSERT_EQ(jpp::Result::OK,
+            document.Reparse(text.c_str(), jpp::Edit{offset, 0, 1}));
+  EXPECT_EQ(std::strlen("12345"), document.ReparsedLength());
+  offset = text.find("1235");
+  text.insert(offset, "9");
+  ASSERT_EQ(jpp::Result::OK,
+            document.Reparse(text.c_str(), jpp::Edit{offset, 0, 1}));
+  EXPECT_EQ(std::strlen("91235"), document.ReparsedLength());
+
+  jpp::Value value;
+  ASSERT_EQ(jpp::Result::OK, jpp::JSON::Parse(&value, text.c_str()));
+  EXPECT_TRUE(jpp::JSON::Equal(&value, &document.Root()));
+}
+
+TEST(IncrementalTest, Escalate) {
+  std::string text = "{\"a\":[1,2,3],\"b\":{\"c\":\"d\"}}";
+  jpp::IncrementalDocument document;
+  ASSERT_EQ(jpp::Result::OK, document.Parse(text.c_str()));
+
+  // no longer a single value, the array has to be re-parsed
+  ApplyEdit(&document, &text, "2", "2,2.5");
+  EXPECT_EQ(std::strlen("[1,2,2.5,3]"), document.ReparsedLength());
+
+  // keys have no value of their own, the object is re-parsed
+  ApplyEdit(&document, &text, "\"c\"", "\"key\"");
+  EXPECT_EQ(std::strlen("{\"key\":\"d\"}"), document.ReparsedLength());
+
+  // removing a member
+  ApplyEdit(&document, &text, ",\"b\":{\"key\":\"d\"}", "");
+  EXPECT_EQ(text.size(), document.ReparsedLength());
+
+  // whitespace at the edge of a value
+  ApplyEdit(&document, &text, "1", "1 ");
+  ApplyEdit(&document, &text, "[1 ", "[ 1 ");
+}
+
+TEST(IncrementalTest, Error) {
+  std::string text = "[\"a\", {\"b\": 1}]";
+  jpp::IncrementalDocument document;
+  ASSERT_EQ(jpp::Result::OK, document.Parse(text.c_str()));
+
+  ApplyEdit(&document, &text, "1", "1}",
+            jpp::Result::MissingCommaOrSquareBracket);
+  EXPECT_EQ(jpp::Type::Null, jpp::JSON::GetType(&document.Root()));
+
+  // the next edit recovers with a full parse
+  ApplyEdit(&document, &text, "1}", "1");
+  EXPECT_EQ(text.size(), document.ReparsedLength());
+
+  ApplyEdit(&document, &text, "\"a\"", "\"a",
+            jpp::Result::MissingCommaOrSquareBracket);
+  ApplyEdit(&document, &text, "\"a", "\"a\"");
+}
+
+TEST(IncrementalTest, MaxDepth) {
+  jpp::Options options;
+  options.max_depth = 3;
+  std::string text = "[[[1]]]";
+  jpp::IncrementalDocument document(options);
+  ASSERT_EQ(jpp::Result::OK, document.Parse(text.c_str()));
+
+  ApplyEdit(&document, &text, "1", "[1]", jpp::Result::NestingTooDeep);
+}
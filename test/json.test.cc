@@ -10,6 +10,13 @@
  */
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+
 #define INCLUDE_JPP_JSON
 #include "json.h"
 
@@ -199,3 +206,567 @@ TEST(JSONParseTest, ParseString) {
 
   jpp::JSON::FreeValue(&value);
 }
+
+TEST(JSONParseTest, ParseStringEscape) {
+  jpp::Value value{};
+
+  EXPECT_EQ(jpp::Result::OK, jpp::JSON::Parse(&value, "\"Hello\""));
+  EXPECT_STREQ("Hello", jpp::JSON::GetString(&value));
+  EXPECT_EQ(static_cast<std::size_t>(5), jpp::JSON::GetStringLength(&value));
+
+  EXPECT_EQ(jpp::Result::OK,
+            jpp::JSON::Parse(&value, "\"\\\" \\\\ \\/ \\b \\f \\n \\r \\t\""));
+  EXPECT_STREQ("\" \\ / \b \f \n \r \t", jpp::JSON::GetString(&value));
+
+  EXPECT_EQ(jpp::Result::MissingQuotationMark,
+            jpp::JSON::Parse(&value, "\"abc"));
+  EXPECT_EQ(jpp::Result::InvalidStringEscape,
+            jpp::JSON::Parse(&value, "\"\\v\""));
+  EXPECT_EQ(jpp::Result::InvalidStringCharacter,
+            jpp::JSON::Parse(&value, "\"\x01\""));
+}
+
+TEST(JSONValueTest, MoveValue) {
+  jpp::Value source{};
+  jpp::JSON::SetString(&source, "Hello", 5);
+
+  jpp::Value target(std::move(source));
+  EXPECT_EQ(jpp::Type::Null, source.type);
+  EXPECT_EQ(jpp::Type::String, target.type);
+  EXPECT_STREQ("Hello", jpp::JSON::GetString(&target));
+
+  jpp::Value other{};
+  jpp::JSON::SetNumber(&other, 1.5);
+  other = std::move(target);
+  EXPECT_EQ(jpp::Type::Null, target.type);
+  EXPECT_STREQ("Hello", jpp::JSON::GetString(&other));
+
+  // self move keeps the value
+  jpp::Value& alias = other;
+  other = std::move(alias);
+  EXPECT_STREQ("Hello", jpp::JSON::GetString(&other));
+}
+
+TEST(JSONValueTest, MoveFromChild) {
+  // a child taken out of its own parent must not be freed with it
+  jpp::Value value{};
+  ASSERT_EQ(jpp::Result::OK, jpp::JSON::Parse(&value, "[[1,\"abc\"],2]"));
+  value = std::move(*jpp::JSON::GetArrayElement(&value, 0));
+  char* text = jpp::JSON::Stringify(&value, nullptr);
+  EXPECT_STREQ("[1,\"abc\"]", text);
+  free(text);
+
+  ASSERT_EQ(jpp::Result::OK,
+            jpp::JSON::Parse(&value, "{\"k\":{\"x\":[\"deep\"]}}"));
+  jpp::Value* deep = jpp::JSON::GetArrayElement(
+      jpp::JSON::GetObjectValue(jpp::JSON::GetObjectValue(&value, 0), 0), 0);
+  jpp::JSON::MoveValue(&value, deep);
+  EXPECT_STREQ("deep", jpp::JSON::GetString(&value));
+}
+
+TEST(JSONValueTest, SwapValue) {
+  jpp::Value lhs{};
+  jpp::Value rhs{};
+  jpp::JSON::SetString(&lhs, "Hello", 5);
+  jpp::JSON::SetNumber(&rhs, 2.0);
+
+  lhs.Swap(rhs);
+  EXPECT_EQ(jpp::Type::Number, lhs.type);
+  EXPECT_DOUBLE_EQ(2.0, jpp::JSON::GetNumber(&lhs));
+  EXPECT_STREQ("Hello", jpp::JSON::GetString(&rhs));
+
+  using std::swap;
+  swap(lhs, rhs);
+  EXPECT_STREQ("Hello", jpp::JSON::GetString(&lhs));
+  EXPECT_DOUBLE_EQ(2.0, jpp::JSON::GetNumber(&rhs));
+}
+
+TEST(JSONValueTest, CloneValue) {
+  jpp::Value value{};
+  jpp::JSON::SetString(&value, "Hello", 5);
+
+  jpp::Value copy = value.Clone();
+  EXPECT_STREQ("Hello", jpp::JSON::GetString(&copy));
+  EXPECT_NE(jpp::JSON::GetString(&value), jpp::JSON::GetString(&copy));
+
+  jpp::JSON::SetBoolean(&value, true);
+  EXPECT_STREQ("Hello", jpp::JSON::GetString(&copy));
+}
+
+TEST(JSONDocumentTest, ParseAndRelease) {
+  jpp::Document document;
+
+  EXPECT_EQ(jpp::Result::OK, document.Parse("\"Hello\""));
+  EXPECT_STREQ("Hello", jpp::JSON::GetString(&document.Root()));
+
+  jpp::Document copy = document.Clone();
+  EXPECT_EQ(jpp::Result::OK, document.Parse("true"));
+  EXPECT_EQ(jpp::Type::True, jpp::JSON::GetType(&document.Root()));
+  EXPECT_STREQ("Hello", jpp::JSON::GetString(&copy.Root()));
+
+  jpp::Value released = copy.Release();
+  EXPECT_EQ(jpp::Type::Null, jpp::JSON::GetType(&copy.Root()));
+  EXPECT_STREQ("Hello", jpp::JSON::GetString(&released));
+
+  jpp::Document moved(std::move(document));
+  EXPECT_EQ(jpp::Type::True, jpp::JSON::GetType(&moved.Root()));
+}
+
+TEST(JSONHashTest, HashAndEqual) {
+  jpp::Value lhs{};
+  jpp::Value rhs{};
+  std::uint64_t hash = 0;
+
+  EXPECT_EQ(jpp::Result::OK, jpp::JSON::Parse(&lhs, " \"Hello\" ", &hash));
+  EXPECT_EQ(jpp::JSON::Hash(&lhs), hash);
+  jpp::JSON::SetString(&rhs, "Hello", 5);
+  EXPECT_EQ(jpp::JSON::Hash(&lhs), jpp::JSON::Hash(&rhs));
+  EXPECT_TRUE(jpp::JSON::Equal(&lhs, &rhs));
+
+  EXPECT_EQ(jpp::Result::OK, jpp::JSON::Parse(&lhs, "-0", &hash));
+  jpp::JSON::SetNumber(&rhs, 0.0);
+  EXPECT_EQ(hash, jpp::JSON::Hash(&rhs));
+  EXPECT_TRUE(jpp::JSON::Equal(&lhs, &rhs));
+
+  EXPECT_EQ(jpp::Result::OK, jpp::JSON::Parse(&lhs, "1e2"));
+  EXPECT_EQ(jpp::Result::OK, jpp::JSON::Parse(&rhs, "100.0"));
+  EXPECT_EQ(jpp::JSON::Hash(&lhs), jpp::JSON::Hash(&rhs));
+  EXPECT_TRUE(jpp::JSON::Equal(&lhs, &rhs));
+
+  // types are kept apart
+  EXPECT_EQ(jpp::Result::OK, jpp::JSON::Parse(&lhs, "false"));
+  EXPECT_EQ(jpp::Result::OK, jpp::JSON::Parse(&rhs, "null"));
+  EXPECT_NE(jpp::JSON::Hash(&lhs), jpp::JSON::Hash(&rhs));
+  EXPECT_FALSE(jpp::JSON::Equal(&lhs, &rhs));
+  EXPECT_EQ(jpp::Result::OK, jpp::JSON::Parse(&rhs, "\"\""));
+  EXPECT_NE(jpp::JSON::Hash(&lhs), jpp::JSON::Hash(&rhs));
+}
+
+TEST(JSONHashTest, DocumentEqual) {
+  jpp::Document lhs;
+  jpp::Document rhs;
+
+  EXPECT_EQ(jpp::Result::OK, lhs.Parse("\"abc\""));
+  EXPECT_EQ(jpp::Result::OK, rhs.Parse("\n\t\"abc\"  "));
+  EXPECT_EQ(lhs.Hash(), rhs.Hash());
+  EXPECT_TRUE(lhs == rhs);
+
+  jpp::JSON::SetString(&rhs.Root(), "abd", 3);
+  EXPECT_NE(lhs.Hash(), rhs.Hash());
+  EXPECT_TRUE(lhs != rhs);
+
+  // changes through a reference taken before hashing are seen as well
+  jpp::Value& root = rhs.Root();
+  EXPECT_NE(lhs.Hash(), rhs.Hash());
+  jpp::JSON::SetString(&root, "abc", 3);
+  EXPECT_EQ(lhs.Hash(), rhs.Hash());
+  EXPECT_TRUE(lhs == rhs);
+  EXPECT_TRUE(jpp::JSON::Equal(&lhs.Root(), &rhs.Root()));
+}
+
+TEST(JSONParseTest, ParseArray) {
+  jpp::Value value{};
+
+  EXPECT_EQ(jpp::Result::OK, jpp::JSON::Parse(&value, "[ ]"));
+  EXPECT_EQ(jpp::Type::Array, jpp::JSON::GetType(&value));
+  EXPECT_EQ(static_cast<std::size_t>(0), jpp::JSON::GetArraySize(&value));
+
+  EXPECT_EQ(jpp::Result::OK,
+            jpp::JSON::Parse(&value,
+                             "[ null , false , true , 123 , \"abc\" ]"));
+  EXPECT_EQ(jpp::Type::Array, jpp::JSON::GetType(&value));
+  EXPECT_EQ(static_cast<std::size_t>(5), jpp::JSON::GetArraySize(&value));
+  EXPECT_EQ(jpp::Type::Null,
+            jpp::JSON::GetType(jpp::JSON::GetArrayElement(&value, 0)));
+  EXPECT_EQ(jpp::Type::False,
+            jpp::JSON::GetType(jpp::JSON::GetArrayElement(&value, 1)));
+  EXPECT_EQ(jpp::Type::True,
+            jpp::JSON::GetType(jpp::JSON::GetArrayElement(&value, 2)));
+  EXPECT_DOUBLE_EQ(123.0,
+                   jpp::JSON::GetNumber(jpp::JSON::GetArrayElement(&value, 3)));
+  EXPECT_STREQ("abc",
+               jpp::JSON::GetString(jpp::JSON::GetArrayElement(&value, 4)));
+
+  EXPECT_EQ(jpp::Result::OK,
+            jpp::JSON::Parse(&value,
+                             "[ [ ] , [ 0 ] , [ 0 , 1 ] , [ 0 , 1 , 2 ] ]"));
+  EXPECT_EQ(static_cast<std::size_t>(4), jpp::JSON::GetArraySize(&value));
+  for (std::size_t i = 0; i < 4; ++i) {
+    const jpp::Value* element = jpp::JSON::GetArrayElement(&value, i);
+    EXPECT_EQ(jpp::Type::Array, jpp::JSON::GetType(element));
+    EXPECT_EQ(i, jpp::JSON::GetArraySize(element));
+    for (std::size_t j = 0; j < i; ++j) {
+      EXPECT_DOUBLE_EQ(static_cast<double>(j),
+                       jpp::JSON::GetNumber(
+                           jpp::JSON::GetArrayElement(element, j)));
+    }
+  }
+
+  EXPECT_EQ(jpp::Result::InvalidValue, jpp::JSON::Parse(&value, "[1,]"));
+  EXPECT_EQ(jpp::Result::InvalidValue,
+            jpp::JSON::Parse(&value, "[\"a\", nul]"));
+  EXPECT_EQ(jpp::Result::MissingCommaOrSquareBracket,
+            jpp::JSON::Parse(&value, "[1"));
+  EXPECT_EQ(jpp::Result::MissingCommaOrSquareBracket,
+            jpp::JSON::Parse(&value, "[1}"));
+  EXPECT_EQ(jpp::Result::MissingCommaOrSquareBracket,
+            jpp::JSON::Parse(&value, "[1 2"));
+  EXPECT_EQ(jpp::Result::MissingCommaOrSquareBracket,
+            jpp::JSON::Parse(&value, "[[]"));
+}
+
+TEST(JSONParseTest, ParseObject) {
+  jpp::Value value{};
+
+  EXPECT_EQ(jpp::Result::OK, jpp::JSON::Parse(&value, " { } "));
+  EXPECT_EQ(jpp::Type::Object, jpp::JSON::GetType(&value));
+  EXPECT_EQ(static_cast<std::size_t>(0), jpp::JSON::GetObjectSize(&value));
+
+  EXPECT_EQ(jpp::Result::OK,
+            jpp::JSON::Parse(&value,
+                             " { "
+                             "\"n\" : null , "
+                             "\"f\" : false , "
+                             "\"t\" : true , "
+                             "\"i\" : 123 , "
+                             "\"s\" : \"abc\", "
+                             "\"a\" : [ 1, 2, 3 ],"
+                             "\"o\" : { \"1\" : 1, \"2\" : 2, \"3\" : 3 }"
+                             " } "));
+  EXPECT_EQ(static_cast<std::size_t>(7), jpp::JSON::GetObjectSize(&value));
+  EXPECT_STREQ("n", jpp::JSON::GetObjectKey(&value, 0));
+  EXPECT_EQ(static_cast<std::size_t>(1),
+            jpp::JSON::GetObjectKeyLength(&value, 0));
+  EXPECT_EQ(jpp::Type::Null,
+            jpp::JSON::GetType(jpp::JSON::GetObjectValue(&value, 0)));
+  EXPECT_STREQ("abc",
+               jpp::JSON::GetString(jpp::JSON::GetObjectValue(&value, 4)));
+  EXPECT_EQ(static_cast<std::size_t>(5),
+            jpp::JSON::FindObjectIndex(&value, "a", 1));
+  EXPECT_EQ(jpp::JSON::kKeyNotExist,
+            jpp::JSON::FindObjectIndex(&value, "x", 1));
+
+  const jpp::Value* object = jpp::JSON::FindObjectValue(&value, "o", 1);
+  ASSERT_NE(nullptr, object);
+  EXPECT_EQ(jpp::Type::Object, jpp::JSON::GetType(object));
+  EXPECT_EQ(static_cast<std::size_t>(3), jpp::JSON::GetObjectSize(object));
+  EXPECT_DOUBLE_EQ(
+      2.0, jpp::JSON::GetNumber(jpp::JSON::FindObjectValue(object, "2", 1)));
+
+  EXPECT_EQ(jpp::Result::MissingKey, jpp::JSON::Parse(&value, "{:1,"));
+  EXPECT_EQ(jpp::Result::MissingKey, jpp::JSON::Parse(&value, "{1:1,"));
+  EXPECT_EQ(jpp::Result::MissingKey, jpp::JSON::Parse(&value, "{\"a\":1,}"));
+  EXPECT_EQ(jpp::Result::MissingColon, jpp::JSON::Parse(&value, "{\"a\"}"));
+  EXPECT_EQ(jpp::Result::MissingColon,
+            jpp::JSON::Parse(&value, "{\"a\",\"b\"}"));
+  EXPECT_EQ(jpp::Result::MissingCommaOrCurlyBracket,
+            jpp::JSON::Parse(&value, "{\"a\":1"));
+  EXPECT_EQ(jpp::Result::MissingCommaOrCurlyBracket,
+            jpp::JSON::Parse(&value, "{\"a\":1]"));
+  EXPECT_EQ(jpp::Result::MissingCommaOrCurlyBracket,
+            jpp::JSON::Parse(&value, "{\"a\":{}"));
+  EXPECT_EQ(jpp::Result::InvalidStringEscape,
+            jpp::JSON::Parse(&value, "{\"a\":[\"\\x\"]}"));
+}
+
+TEST(JSONParseTest, ParseNestingDepth) {
+  jpp::Value value{};
+  jpp::Options options;
+  options.max_depth = 3;
+
+  EXPECT_EQ(jpp::Result::OK,
+            jpp::JSON::Parse(&value, "[{\"a\":[1]}]", options));
+  EXPECT_EQ(jpp::Result::NestingTooDeep,
+            jpp::JSON::Parse(&value, "[{\"a\":[[1]]}]", options));
+  EXPECT_EQ(jpp::Type::Null, jpp::JSON::GetType(&value));
+
+  // hostile input is rejected without exhausting the native stack
+  std::string hostile(1000000, '[');
+  EXPECT_EQ(jpp::Result::NestingTooDeep,
+            jpp::JSON::Parse(&value, hostile.c_str()));
+
+  std::string deep = std::string(JPP_PARSE_MAX_DEPTH, '[') +
+                     std::string(JPP_PARSE_MAX_DEPTH, ']');
+  EXPECT_EQ(jpp::Result::OK, jpp::JSON::Parse(&value, deep.c_str()));
+}
+
+TEST(JSONValueTest, DeepValue) {
+  // every walk over a value is iterative, a raised limit cannot overflow
+  // the native stack either
+  constexpr std::size_t kDepth = 1000000;
+  jpp::Options options;
+  options.max_depth = 2 * kDepth;
+  std::string deep = std::string(kDepth, '[') + "{\"a\":1}" +
+                     std::string(kDepth, ']');
+
+  jpp::Value value;
+  std::uint64_t hash = 0;
+  ASSERT_EQ(jpp::Result::OK,
+            jpp::JSON::Parse(&value, deep.c_str(), options, &hash));
+  EXPECT_EQ(hash, jpp::JSON::Hash(&value));
+
+  jpp::Value copy = value.Clone();
+  EXPECT_TRUE(jpp::JSON::Equal(&value, &copy));
+  EXPECT_EQ(hash, jpp::JSON::Hash(&copy));
+
+  std::size_t length = 0;
+  char* text = jpp::JSON::Stringify(&copy, &length);
+  EXPECT_EQ(deep, std::string(text, length));
+  free(text);
+
+  jpp::Value* inner = &copy;
+  while (jpp::JSON::GetType(inner) == jpp::Type::Array) {
+    inner = jpp::JSON::GetArrayElement(inner, 0);
+  }
+  jpp::JSON::SetNumber(jpp::JSON::GetObjectValue(inner, 0), 2.0);
+  EXPECT_FALSE(jpp::JSON::Equal(&value, &copy));
+  EXPECT_NE(hash, jpp::JSON::Hash(&copy));
+}
+
+TEST(JSONHashTest, HashContainers) {
+  jpp::Document lhs;
+  jpp::Document rhs;
+
+  // member order and whitespace do not matter
+  EXPECT_EQ(jpp::Result::OK,
+            lhs.Parse("{\"id\":1,\"tags\":[\"a\",\"b\"],\"o\":{\"x\":null}}"));
+  EXPECT_EQ(jpp::Result::OK,
+            rhs.Parse("{ \"o\" : { \"x\" : null } , \"tags\" : [ \"a\" , "
+                      "\"b\" ] , \"id\" : 1.0 }"));
+  EXPECT_EQ(jpp::JSON::Hash(&lhs.Root()), lhs.Hash());
+  EXPECT_EQ(jpp::JSON::Hash(&rhs.Root()), rhs.Hash());
+  EXPECT_EQ(lhs.Hash(), rhs.Hash());
+  EXPECT_TRUE(lhs == rhs);
+
+  // element order does
+  EXPECT_EQ(jpp::Result::OK,
+            rhs.Parse("{\"id\":1,\"tags\":[\"b\",\"a\"],\"o\":{\"x\":null}}"));
+  EXPECT_NE(lhs.Hash(), rhs.Hash());
+  EXPECT_TRUE(lhs != rhs);
+
+  EXPECT_EQ(jpp::Result::OK, lhs.Parse("[[]]"));
+  EXPECT_EQ(jpp::Result::OK, rhs.Parse("[{}]"));
+  EXPECT_NE(lhs.Hash(), rhs.Hash());
+  EXPECT_TRUE(lhs != rhs);
+}
+
+TEST(JSONHashTest, EqualDuplicateKeys) {
+  jpp::Value lhs;
+  jpp::Value rhs;
+
+  // every member on either side needs its own partner
+  EXPECT_EQ(jpp::Result::OK, jpp::JSON::Parse(&lhs, "{\"a\":1,\"a\":1}"));
+  EXPECT_EQ(jpp::Result::OK, jpp::JSON::Parse(&rhs, "{\"a\":1,\"b\":2}"));
+  EXPECT_FALSE(jpp::JSON::Equal(&lhs, &rhs));
+  EXPECT_FALSE(jpp::JSON::Equal(&rhs, &lhs));
+
+  // duplicates pair up in order of appearance, other members may move
+  EXPECT_EQ(jpp::Result::OK,
+            jpp::JSON::Parse(&lhs, "{\"x\":0,\"a\":1,\"a\":2}"));
+  EXPECT_EQ(jpp::Result::OK,
+            jpp::JSON::Parse(&rhs, "{\"a\":1,\"a\":2,\"x\":0}"));
+  EXPECT_TRUE(jpp::JSON::Equal(&lhs, &rhs));
+  EXPECT_TRUE(jpp::JSON::Equal(&rhs, &lhs));
+  EXPECT_EQ(jpp::JSON::Hash(&lhs), jpp::JSON::Hash(&rhs));
+
+  EXPECT_EQ(jpp::Result::OK,
+            jpp::JSON::Parse(&rhs, "{\"a\":2,\"x\":0,\"a\":1}"));
+  EXPECT_FALSE(jpp::JSON::Equal(&lhs, &rhs));
+
+  // nested objects keep their own pairing
+  EXPECT_EQ(jpp::Result::OK,
+            jpp::JSON::Parse(&lhs, "{\"o\":{\"k\":1,\"k\":[{}]},\"p\":{}}"));
+  EXPECT_EQ(jpp::Result::OK,
+            jpp::JSON::Parse(&rhs, "{\"p\":{},\"o\":{\"k\":1,\"k\":[{}]}}"));
+  EXPECT_TRUE(jpp::JSON::Equal(&lhs, &rhs));
+}
+
+TEST(JSONHashTest, EqualReordered) {
+  // members in reverse order, pairing them must not take quadratic time
+  std::string forward = "{";
+  std::string backward = "{";
+  const int size = 100000;
+  for (int i = 0; i < size; ++i) {
+    std::string member = "\"k" + std::to_string(i) + "\":" + std::to_string(i);
+    forward += (i == 0 ? "" : ",") + member;
+    std::string mirrored = "\"k" + std::to_string(size - 1 - i) +
+                           "\":" + std::to_string(size - 1 - i);
+    backward += (i == 0 ? "" : ",") + mirrored;
+  }
+  forward += "}";
+  backward += "}";
+
+  jpp::Value lhs;
+  jpp::Value rhs;
+  ASSERT_EQ(jpp::Result::OK, jpp::JSON::Parse(&lhs, forward.c_str()));
+  ASSERT_EQ(jpp::Result::OK, jpp::JSON::Parse(&rhs, backward.c_str()));
+  EXPECT_TRUE(jpp::JSON::Equal(&lhs, &rhs));
+
+  jpp::JSON::SetNumber(jpp::JSON::GetObjectValue(&rhs, 0), -1.0);
+  EXPECT_FALSE(jpp::JSON::Equal(&lhs, &rhs));
+
+  // keys that are prefixes of others, duplicates among moved members
+  ASSERT_EQ(jpp::Result::OK,
+            jpp::JSON::Parse(&lhs, "{\"ab\":1,\"a\":2,\"\":3,\"a\":4}"));
+  ASSERT_EQ(jpp::Result::OK,
+            jpp::JSON::Parse(&rhs, "{\"a\":2,\"\":3,\"a\":4,\"ab\":1}"));
+  EXPECT_TRUE(jpp::JSON::Equal(&lhs, &rhs));
+  ASSERT_EQ(jpp::Result::OK,
+            jpp::JSON::Parse(&rhs, "{\"a\":4,\"\":3,\"a\":2,\"ab\":1}"));
+  EXPECT_FALSE(jpp::JSON::Equal(&lhs, &rhs));
+  ASSERT_EQ(jpp::Result::OK,
+            jpp::JSON::Parse(&rhs, "{\"a\":2,\"\":3,\"ab\":4,\"ab\":1}"));
+  EXPECT_FALSE(jpp::JSON::Equal(&lhs, &rhs));
+}
+
+TEST(JSONHashTest, EqualWithHashes) {
+  jpp::Value lhs;
+  jpp::Value rhs;
+  std::uint64_t lhs_hash = 0;
+  std::uint64_t rhs_hash = 0;
+  ASSERT_EQ(jpp::Result::OK,
+            jpp::JSON::Parse(&lhs, "{\"a\":[1,2],\"b\":null}", &lhs_hash));
+  ASSERT_EQ(jpp::Result::OK,
+            jpp::JSON::Parse(&rhs, "{\"b\":null,\"a\":[1,2]}", &rhs_hash));
+  EXPECT_TRUE(jpp::JSON::Equal(&lhs, lhs_hash, &rhs, rhs_hash));
+
+  // a hash mismatch rejects without looking at the values
+  EXPECT_FALSE(jpp::JSON::Equal(&lhs, lhs_hash, &rhs, rhs_hash + 1));
+}
+
+TEST(JSONValueTest, CloneContainers) {
+  jpp::Value value{};
+  EXPECT_EQ(jpp::Result::OK,
+            jpp::JSON::Parse(&value,
+                             "{\"a\":[1,\"x\",{\"b\":true}],\"c\":{}}"));
+
+  jpp::Value copy = value.Clone();
+  EXPECT_TRUE(jpp::JSON::Equal(&value, &copy));
+  EXPECT_NE(jpp::JSON::GetObjectKey(&value, 0),
+            jpp::JSON::GetObjectKey(&copy, 0));
+
+  jpp::JSON::SetNumber(
+      jpp::JSON::GetArrayElement(jpp::JSON::GetObjectValue(&copy, 0), 0), 2.0);
+  EXPECT_FALSE(jpp::JSON::Equal(&value, &copy));
+}
+
+TEST(JSONParseTest, ParseLazyNumber) {
+  jpp::Value value{};
+  jpp::Options options;
+  options.lazy_numbers = true;
+
+  const char* json = "[1.5, -0, 12345678901234567890123, 9007199254740993]";
+  EXPECT_EQ(jpp::Result::OK, jpp::JSON::Parse(&value, json, options));
+
+  const jpp::Value* number = jpp::JSON::GetArrayElement(&value, 0);
+  std::size_t length = 0;
+  EXPECT_EQ(json + 1, jpp::JSON::GetNumberLexeme(number, &length));
+  EXPECT_EQ(static_cast<std::size_t>(3), length);
+  EXPECT_FALSE(number->number.converted);
+  EXPECT_DOUBLE_EQ(1.5, jpp::JSON::GetNumber(number));
+  EXPECT_TRUE(number->number.converted);
+
+  // integers are read exactly from the lexeme, and cached below 2^53
+  const jpp::Value* big = jpp::JSON::GetArrayElement(&value, 3);
+  EXPECT_EQ(INT64_C(9007199254740993), jpp::JSON::GetInt64(big));
+  EXPECT_TRUE(big->number.converted);
+  EXPECT_EQ(INT64_C(9007199254740993), jpp::JSON::GetInt64(big));
+  EXPECT_EQ(INT64_C(1), jpp::JSON::GetInt64(number));
+  const jpp::Value* zero = jpp::JSON::GetArrayElement(&value, 1);
+  EXPECT_EQ(INT64_C(0), jpp::JSON::GetInt64(zero));
+  EXPECT_TRUE(zero->number.converted);
+  EXPECT_TRUE(std::signbit(jpp::JSON::GetNumber(zero)));
+
+  // same structure as eagerly parsed numbers
+  jpp::Value eager{};
+  EXPECT_EQ(jpp::Result::OK, jpp::JSON::Parse(&eager, json));
+  EXPECT_EQ(jpp::JSON::Hash(&eager), jpp::JSON::Hash(&value));
+  EXPECT_TRUE(jpp::JSON::Equal(&eager, &value));
+}
+
+TEST(JSONHashTest, HashLazyNumber) {
+  jpp::Options options;
+  options.lazy_numbers = true;
+
+  // neither parsing nor hashing a document converts its numbers
+  jpp::Document doc;
+  EXPECT_EQ(jpp::Result::OK, doc.Parse("[1.5, 2]", options));
+  const jpp::Value* number = jpp::JSON::GetArrayElement(&doc.Root(), 0);
+  EXPECT_FALSE(number->number.converted);
+
+  jpp::Document eager;
+  EXPECT_EQ(jpp::Result::OK, eager.Parse("[1.5, 2]"));
+  EXPECT_EQ(eager.Hash(), doc.Hash());
+  EXPECT_FALSE(number->number.converted);
+  EXPECT_FALSE(jpp::JSON::GetArrayElement(&doc.Root(), 1)->number.converted);
+}
+
+TEST(JSONStringifyTest, Stringify) {
+  const char* cases[] = {
+      "null",
+      "false",
+      "true",
+      "0",
+      "-1.5",
+      "\"\"",
+      "\"Hello\"",
+      "\"\\\" \\\\ / \\b \\f \\n \\r \\t\"",
+      "[]",
+      "[null,false,true,123,\"abc\",[1,2,3]]",
+      "{}",
+      "{\"n\":null,\"a\":[1,2],\"o\":{\"1\":1,\"2\":\"x\"}}",
+  };
+
+  for (const char* json : cases) {
+    jpp::Value value{};
+    EXPECT_EQ(jpp::Result::OK, jpp::JSON::Parse(&value, json));
+
+    std::size_t length = 0;
+    char* text = jpp::JSON::Stringify(&value, &length);
+    EXPECT_STREQ(json, text);
+    EXPECT_EQ(std::strlen(json), length);
+    free(text);
+  }
+
+  // control characters without short escape
+  jpp::Value value{};
+  jpp::JSON::SetString(&value, "\x01", 1);
+  char* escaped = jpp::JSON::Stringify(&value, nullptr);
+  EXPECT_STREQ("\"\\u0001\"", escaped);
+  free(escaped);
+
+  // any double round-trips
+  jpp::JSON::SetNumber(&value, 0.1);
+  char* text = jpp::JSON::Stringify(&value, nullptr);
+  jpp::Value parsed{};
+  EXPECT_EQ(jpp::Result::OK, jpp::JSON::Parse(&parsed, text));
+  EXPECT_EQ(0.1, jpp::JSON::GetNumber(&parsed));
+  free(text);
+
+  // JSON has no inf or nan
+  const double non_finite[] = {std::numeric_limits<double>::infinity(),
+                               -std::numeric_limits<double>::infinity(),
+                               std::numeric_limits<double>::quiet_NaN()};
+  for (double number : non_finite) {
+    jpp::JSON::SetNumber(&value, number);
+    text = jpp::JSON::Stringify(&value, nullptr);
+    EXPECT_STREQ("null", text);
+    free(text);
+  }
+}
+
+TEST(JSONStringifyTest, StringifyLazyNumber) {
+  jpp::Value value{};
+  jpp::Options options;
+  options.lazy_numbers = true;
+
+  // passthrough keeps the source text byte for byte
+  const char* json =
+      "[1.0E+2,0.10000000000000000000001,-123456789012345678901]";
+  EXPECT_EQ(jpp::Result::OK, jpp::JSON::Parse(&value, json, options));
+  jpp::JSON::GetNumber(jpp::JSON::GetArrayElement(&value, 0));
+
+  char* text = jpp::JSON::Stringify(&value, nullptr);
+  EXPECT_STREQ(json, text);
+  free(text);
+}
@@ -0,0 +1,122 @@
+/**
+ * @file key_pool.test.cc
+ * @author Mao Zhang (mao.zhang233@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "json.h"
+#include "key_pool.h"
+
+TEST(KeyPoolTest, Intern) {
+  jpp::KeyPool pool;
+
+  const char* id = pool.Intern("id", 2);
+  ASSERT_NE(nullptr, id);
+  EXPECT_STREQ("id", id);
+  EXPECT_EQ(id, pool.Intern("id", 2));
+  EXPECT_EQ(id, pool.Find("id", 2));
+  EXPECT_EQ(nullptr, pool.Find("timestamp", 9));
+  EXPECT_NE(id, pool.Intern("timestamp", 9));
+  EXPECT_EQ(static_cast<std::size_t>(2), pool.Size());
+
+  // keys are not null terminated on input
+  EXPECT_EQ(id, pool.Intern("idx", 2));
+}
+
+TEST(KeyPoolTest, Bounded) {
+  jpp::KeyPool pool(2, 4);
+
+  EXPECT_NE(nullptr, pool.Intern("a", 1));
+  EXPECT_EQ(nullptr, pool.Intern("toolong", 7));
+  EXPECT_NE(nullptr, pool.Intern("b", 1));
+  EXPECT_EQ(nullptr, pool.Intern("c", 1));
+  EXPECT_NE(nullptr, pool.Intern("a", 1));
+  EXPECT_EQ(static_cast<std::size_t>(2), pool.Size());
+}
+
+TEST(KeyPoolTest, ConcurrentIntern) {
+  jpp::KeyPool pool;
+  std::vector<std::thread> threads;
+  std::vector<std::vector<const char*>> results(4);
+
+  for (std::size_t t = 0; t < results.size(); ++t) {
+    threads.emplace_back([&pool, &results, t] {
+      for (int i = 0; i < 256; ++i) {
+        std::string key = "key" + std::to_string(i);
+        results[t].push_back(pool.Intern(key.data(), key.size()));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(static_cast<std::size_t>(256), pool.Size());
+  for (std::size_t t = 1; t < results.size(); ++t) {
+    EXPECT_EQ(results[0], results[t]);
+  }
+}
+
+TEST(KeyPoolTest, ParseWithPool) {
+  jpp::KeyPool pool;
+  jpp::Options options;
+  options.key_pool = &pool;
+
+  jpp::Document lhs;
+  jpp::Document rhs;
+  EXPECT_EQ(jpp::Result::OK,
+            lhs.Parse("{\"id\":1,\"user_agent\":\"a\"}", options));
+  EXPECT_EQ(jpp::Result::OK,
+            rhs.Parse("{\"user_agent\":\"b\",\"id\":2}", options));
+
+  // keys are shared across documents
+  EXPECT_EQ(jpp::JSON::GetObjectKey(&lhs.Root(), 0),
+            jpp::JSON::GetObjectKey(&rhs.Root(), 1));
+  EXPECT_EQ(static_cast<std::size_t>(2), pool.Size());
+
+  const char* id = pool.Find("id", 2);
+  EXPECT_EQ(static_cast<std::size_t>(0),
+            jpp::JSON::FindInternedObjectIndex(&lhs.Root(), id, 2));
+  EXPECT_EQ(static_cast<std::size_t>(1),
+            jpp::JSON::FindInternedObjectIndex(&rhs.Root(), id, 2));
+  EXPECT_EQ(static_cast<std::size_t>(1),
+            jpp::JSON::FindObjectIndex(&rhs.Root(), "id", 2));
+
+  // clones share interned keys, freeing either leaves the pool intact
+  jpp::Document copy = lhs.Clone();
+  EXPECT_EQ(jpp::JSON::GetObjectKey(&lhs.Root(), 0),
+            jpp::JSON::GetObjectKey(&copy.Root(), 0));
+  EXPECT_TRUE(lhs == copy);
+  lhs.Parse("null");
+  EXPECT_STREQ("id", jpp::JSON::GetObjectKey(&copy.Root(), 0));
+}
+
+TEST(KeyPoolTest, ParseWithFullPool) {
+  jpp::KeyPool pool(1);
+  jpp::Options options;
+  options.key_pool = &pool;
+
+  jpp::Value value{};
+  EXPECT_EQ(jpp::Result::OK,
+            jpp::JSON::Parse(&value, "{\"a\":1,\"b\":2}", options));
+  EXPECT_TRUE(value.object.members[0].key.interned);
+  EXPECT_FALSE(value.object.members[1].key.interned);
+
+  // rejected keys are still found by content
+  const char* b = "b";
+  EXPECT_EQ(static_cast<std::size_t>(1),
+            jpp::JSON::FindInternedObjectIndex(&value, b, 1));
+
+  EXPECT_EQ(jpp::Result::MissingColon,
+            jpp::JSON::Parse(&value, "{\"a\":1,\"c\"}", options));
+}
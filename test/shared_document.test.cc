@@ -0,0 +1,128 @@
+/**
+ * @file shared_document.test.cc
+ * @author Mao Zhang (mao.zhang233@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "json.h"
+#include "shared_document.h"
+
+TEST(SharedDocumentTest, PinAndStore) {
+  jpp::SharedDocument shared;
+  EXPECT_FALSE(shared.Pin());
+
+  EXPECT_EQ(jpp::Result::OK, shared.Load("{\"version\":1}"));
+  jpp::SharedDocument::Guard first = shared.Pin();
+  ASSERT_TRUE(first);
+
+  jpp::Document document;
+  EXPECT_EQ(jpp::Result::OK, document.Parse("{\"version\":2}"));
+  shared.Store(std::move(document));
+
+  // the pinned snapshot survives the swap
+  EXPECT_DOUBLE_EQ(1.0, jpp::JSON::GetNumber(jpp::JSON::FindObjectValue(
+                            &first->Root(), "version", 7)));
+  EXPECT_EQ(static_cast<std::size_t>(1), shared.RetiredCount());
+
+  jpp::SharedDocument::Guard second = shared.Pin();
+  EXPECT_DOUBLE_EQ(2.0, jpp::JSON::GetNumber(jpp::JSON::FindObjectValue(
+                            &second->Root(), "version", 7)));
+
+  // readers never free it, the writer side does once it is unpinned
+  first.Reset();
+  EXPECT_EQ(static_cast<std::size_t>(1), shared.RetiredCount());
+  shared.Reclaim();
+  EXPECT_EQ(static_cast<std::size_t>(0), shared.RetiredCount());
+
+  // a failed load keeps the current snapshot
+  EXPECT_EQ(jpp::Result::MissingColon, shared.Load("{\"version\"}"));
+  EXPECT_EQ(second.Get(), shared.Pin().Get());
+}
+
+TEST(SharedDocumentTest, FrozenLazyNumbers) {
+  jpp::SharedDocument shared;
+  jpp::Options options;
+  options.lazy_numbers = true;
+
+  std::string json = "[12345678901234567890.5,2]";
+  EXPECT_EQ(jpp::Result::OK, shared.Load(json.c_str(), options));
+  json.assign(json.size(), 'x');
+
+  // snapshot owns its text, numbers were converted before sharing
+  jpp::SharedDocument::Guard guard = shared.Pin();
+  const jpp::Value* number = jpp::JSON::GetArrayElement(&guard->Root(), 0);
+  EXPECT_TRUE(number->number.converted);
+  char* text = jpp::JSON::Stringify(&guard->Root(), nullptr);
+  EXPECT_STREQ("[12345678901234567890.5,2]", text);
+  free(text);
+
+  EXPECT_EQ(jpp::JSON::Hash(&guard->Root()), guard->Hash());
+}
+
+TEST(SharedDocumentTest, FrozenEqual) {
+  jpp::Document a;
+  jpp::Document b;
+  jpp::Document c;
+  ASSERT_EQ(jpp::Result::OK, a.Parse("{\"x\":1,\"y\":[true]}"));
+  ASSERT_EQ(jpp::Result::OK, b.Parse("{\"y\":[true],\"x\":1.0}"));
+  ASSERT_EQ(jpp::Result::OK, c.Parse("{\"y\":[true],\"x\":2}"));
+
+  jpp::FrozenDocument first(std::move(a));
+  jpp::FrozenDocument second(std::move(b));
+  jpp::FrozenDocument third(std::move(c));
+  EXPECT_TRUE(first == second);
+  EXPECT_TRUE(first != third);
+}
+
+TEST(SharedDocumentTest, ConcurrentReload) {
+  jpp::SharedDocument shared(8);
+  EXPECT_EQ(jpp::Result::OK, shared.Load("{\"a\":0,\"b\":0}"));
+
+  std::atomic<bool> stop{false};
+  std::atomic<int> torn{0};
+  std::vector<std::thread> readers;
+
+  for (int t = 0; t < 4; ++t) {
+    readers.emplace_back([&shared, &stop, &torn] {
+      while (!stop.load()) {
+        jpp::SharedDocument::Guard guard = shared.Pin();
+        const jpp::Value& root = guard->Root();
+        double a =
+            jpp::JSON::GetNumber(jpp::JSON::FindObjectValue(&root, "a", 1));
+        double b =
+            jpp::JSON::GetNumber(jpp::JSON::FindObjectValue(&root, "b", 1));
+        if (a != b) {
+          ++torn;
+        }
+      }
+    });
+  }
+
+  for (int i = 1; i <= 200; ++i) {
+    std::string json =
+        "{\"a\":" + std::to_string(i) + ",\"b\":" + std::to_string(i) + "}";
+    EXPECT_EQ(jpp::Result::OK, shared.Load(json.c_str()));
+  }
+
+  stop.store(true);
+  for (std::thread& reader : readers) {
+    reader.join();
+  }
+
+  EXPECT_EQ(0, torn.load());
+  shared.Reclaim();
+  EXPECT_EQ(static_cast<std::size_t>(0), shared.RetiredCount());
+}